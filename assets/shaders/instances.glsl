@@ -0,0 +1,6 @@
+// world matrix of every visible instance of every draw, row major like Matrix4x4
+// INSTANCE_BINDING is defined by the program that includes this
+layout (std430, binding = INSTANCE_BINDING, row_major) readonly buffer Instances
+{
+    mat4 models[];
+};
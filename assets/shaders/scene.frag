@@ -0,0 +1,9 @@
+#version 460 core
+
+smooth in vec4 pass_color;
+out vec4 out_color;
+
+void main()
+{
+    out_color = pass_color;
+}
@@ -0,0 +1,15 @@
+#version 460 core
+
+#include "instances.glsl"
+
+layout (location = 0) in vec4 vector_position;
+layout (location = 1) in vec4 color;
+uniform mat4 view;
+uniform mat4 projection;
+smooth out vec4 pass_color;
+
+void main()
+{
+    gl_Position = projection * view * models[gl_InstanceID + gl_BaseInstance] * vector_position;
+    pass_color = color;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "Quaternion.hpp"
+#include "TransformComponent.hpp"
+#include "Vector3.hpp"
+
+// axis aligned bounding box
+struct Aabb {
+    Vector3f min;
+    Vector3f max;
+
+    // bounds of local_bounds after applying transform's scale, rotation and translation
+    auto static from_transform(const Aabb& local_bounds, const TransformComponent& transform) -> Aabb
+    {
+        const Vector3f local_center = (local_bounds.min + local_bounds.max) * 0.5f;
+        const Vector3f local_half_extents = (local_bounds.max - local_bounds.min) * 0.5f;
+        const Vector3f center = transform.rotation.rotate_point(local_center.element_wise(transform.scale))
+            + transform.position;
+        const Vector3f scaled = local_half_extents.element_wise(transform.scale);
+
+        // half extents of the rotated box are the absolute rotation matrix applied to the scaled extents
+        const Quaternionf& q = transform.rotation;
+        const float m00 = 1 - 2 * q.y * q.y - 2 * q.z * q.z;
+        const float m01 = 2 * q.x * q.y - 2 * q.w * q.z;
+        const float m02 = 2 * q.x * q.z + 2 * q.w * q.y;
+        const float m10 = 2 * q.x * q.y + 2 * q.w * q.z;
+        const float m11 = 1 - 2 * q.x * q.x - 2 * q.z * q.z;
+        const float m12 = 2 * q.y * q.z - 2 * q.w * q.x;
+        const float m20 = 2 * q.x * q.z - 2 * q.w * q.y;
+        const float m21 = 2 * q.y * q.z + 2 * q.w * q.x;
+        const float m22 = 1 - 2 * q.x * q.x - 2 * q.y * q.y;
+        const Vector3f half_extents{
+            std::fabs(m00) * std::fabs(scaled.x) + std::fabs(m01) * std::fabs(scaled.y) + std::fabs(m02) * std::fabs(scaled.z),
+            std::fabs(m10) * std::fabs(scaled.x) + std::fabs(m11) * std::fabs(scaled.y) + std::fabs(m12) * std::fabs(scaled.z),
+            std::fabs(m20) * std::fabs(scaled.x) + std::fabs(m21) * std::fabs(scaled.y) + std::fabs(m22) * std::fabs(scaled.z),
+        };
+        return {center - half_extents, center + half_extents};
+    }
+
+    auto overlaps(const Aabb& rhs) const -> bool
+    {
+        return min.x <= rhs.max.x && max.x >= rhs.min.x
+            && min.y <= rhs.max.y && max.y >= rhs.min.y
+            && min.z <= rhs.max.z && max.z >= rhs.min.z;
+    }
+
+    auto contains(const Aabb& rhs) const -> bool
+    {
+        return min.x <= rhs.min.x && min.y <= rhs.min.y && min.z <= rhs.min.z
+            && max.x >= rhs.max.x && max.y >= rhs.max.y && max.z >= rhs.max.z;
+    }
+
+    auto merged(const Aabb& rhs) const -> Aabb
+    {
+        return {
+            {std::min(min.x, rhs.min.x), std::min(min.y, rhs.min.y), std::min(min.z, rhs.min.z)},
+            {std::max(max.x, rhs.max.x), std::max(max.y, rhs.max.y), std::max(max.z, rhs.max.z)},
+        };
+    }
+
+    auto expanded(float margin) const -> Aabb
+    {
+        return {min - margin, max + margin};
+    }
+
+    auto center() const -> Vector3f
+    {
+        return (min + max) * 0.5f;
+    }
+
+    auto half_extents() const -> Vector3f
+    {
+        return (max - min) * 0.5f;
+    }
+
+    auto surface_area() const -> float
+    {
+        const Vector3f size = max - min;
+        return 2 * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+};
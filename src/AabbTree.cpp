@@ -0,0 +1,331 @@
+#include "AabbTree.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NOT_DOOM_SSE
+#endif
+
+AabbTree::AabbTree() : nodes_{}, root_{k_null_node}, free_list_{k_null_node}, entity_to_leaf_{}
+{
+}
+
+auto AabbTree::update(int entity_id, const Aabb& bounds) -> bool
+{
+    if (static_cast<size_t>(entity_id) >= entity_to_leaf_.size()) {
+        entity_to_leaf_.resize(entity_id + 1, k_null_node);
+    }
+    int leaf = entity_to_leaf_[entity_id];
+    if (leaf == k_null_node) {
+        leaf = allocate_node();
+        nodes_[leaf].bounds = bounds.expanded(k_fat_margin);
+        nodes_[leaf].height = 0;
+        nodes_[leaf].entity_id = entity_id;
+        insert_leaf(leaf);
+        entity_to_leaf_[entity_id] = leaf;
+        return true;
+    }
+
+    // keep the leaf while the fat bounds still fit the entity reasonably tight
+    const Aabb& fat_bounds = nodes_[leaf].bounds;
+    if (fat_bounds.contains(bounds) && bounds.expanded(4 * k_fat_margin).contains(fat_bounds)) [[likely]] {
+        return false;
+    }
+    remove_leaf(leaf);
+    nodes_[leaf].bounds = bounds.expanded(k_fat_margin);
+    insert_leaf(leaf);
+    return true;
+}
+
+auto AabbTree::remove(int entity_id) -> void
+{
+    if (!contains(entity_id)) [[unlikely]] {
+        return;
+    }
+    const int leaf = entity_to_leaf_[entity_id];
+    remove_leaf(leaf);
+    free_node(leaf);
+    entity_to_leaf_[entity_id] = k_null_node;
+}
+
+auto AabbTree::contains(int entity_id) const -> bool
+{
+    return entity_id >= 0 && static_cast<size_t>(entity_id) < entity_to_leaf_.size()
+        && entity_to_leaf_[entity_id] != k_null_node;
+}
+
+auto AabbTree::get_fat_bounds(int entity_id) const -> const Aabb&
+{
+    assert(contains(entity_id) && "Entity is not in the tree");
+    return nodes_[entity_to_leaf_[entity_id]].bounds;
+}
+
+auto AabbTree::get_height() const -> int
+{
+    return root_ == k_null_node ? 0 : nodes_[root_].height;
+}
+
+auto AabbTree::validate() const -> bool
+{
+    if (root_ == k_null_node) {
+        return true;
+    }
+    return nodes_[root_].parent == k_null_node && validate_node(root_);
+}
+
+auto AabbTree::allocate_node() -> int
+{
+    int node;
+    if (free_list_ != k_null_node) {
+        node = free_list_;
+        free_list_ = nodes_[node].parent;
+    }
+    else {
+        node = static_cast<int>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[node] = {
+        .bounds = {},
+        .parent = k_null_node,
+        .left = k_null_node,
+        .right = k_null_node,
+        .height = 0,
+        .entity_id = -1,
+    };
+    return node;
+}
+
+auto AabbTree::free_node(int node) -> void
+{
+    nodes_[node].parent = free_list_;
+    nodes_[node].height = -1;
+    free_list_ = node;
+}
+
+auto AabbTree::insert_leaf(int leaf) -> void
+{
+    if (root_ == k_null_node) {
+        root_ = leaf;
+        nodes_[leaf].parent = k_null_node;
+        return;
+    }
+
+    // descend towards the sibling that increases the total surface area the least
+    const Aabb leaf_bounds = nodes_[leaf].bounds;
+    int index = root_;
+    while (!nodes_[index].is_leaf()) {
+        const Node& node = nodes_[index];
+        const float area = node.bounds.surface_area();
+        const float combined_area = node.bounds.merged(leaf_bounds).surface_area();
+        // cost of creating a new parent for this node and the leaf
+        const float cost = 2 * combined_area;
+        // minimum cost of pushing the leaf further down the tree
+        const float inheritance_cost = 2 * (combined_area - area);
+
+        const auto descend_cost = [&](int child) -> float {
+            const Aabb& child_bounds = nodes_[child].bounds;
+            const float merged_area = child_bounds.merged(leaf_bounds).surface_area();
+            if (nodes_[child].is_leaf()) {
+                return merged_area + inheritance_cost;
+            }
+            return merged_area - child_bounds.surface_area() + inheritance_cost;
+        };
+        const float left_cost = descend_cost(node.left);
+        const float right_cost = descend_cost(node.right);
+
+        if (cost < left_cost && cost < right_cost) {
+            break;
+        }
+        index = left_cost < right_cost ? node.left : node.right;
+    }
+
+    const int sibling = index;
+    const int old_parent = nodes_[sibling].parent;
+    const int new_parent = allocate_node();
+    nodes_[new_parent].parent = old_parent;
+    nodes_[new_parent].bounds = leaf_bounds.merged(nodes_[sibling].bounds);
+    nodes_[new_parent].height = nodes_[sibling].height + 1;
+    nodes_[new_parent].left = sibling;
+    nodes_[new_parent].right = leaf;
+    nodes_[sibling].parent = new_parent;
+    nodes_[leaf].parent = new_parent;
+    if (old_parent == k_null_node) {
+        root_ = new_parent;
+    }
+    else {
+        replace_child(old_parent, sibling, new_parent);
+    }
+
+    refit_ancestors(new_parent);
+}
+
+auto AabbTree::remove_leaf(int leaf) -> void
+{
+    if (leaf == root_) {
+        root_ = k_null_node;
+        return;
+    }
+
+    const int parent = nodes_[leaf].parent;
+    const int grandparent = nodes_[parent].parent;
+    const int sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+
+    nodes_[sibling].parent = grandparent;
+    free_node(parent);
+    if (grandparent == k_null_node) {
+        root_ = sibling;
+        return;
+    }
+    replace_child(grandparent, parent, sibling);
+    refit_ancestors(grandparent);
+}
+
+auto AabbTree::refit_ancestors(int node) -> void
+{
+    int index = node;
+    while (index != k_null_node) {
+        index = balance(index);
+        Node& current = nodes_[index];
+        current.height = 1 + std::max(nodes_[current.left].height, nodes_[current.right].height);
+        current.bounds = nodes_[current.left].bounds.merged(nodes_[current.right].bounds);
+        index = current.parent;
+    }
+}
+
+auto AabbTree::balance(int a) -> int
+{
+    Node& node_a = nodes_[a];
+    if (node_a.is_leaf() || node_a.height < 2) {
+        return a;
+    }
+
+    const int b = node_a.left;
+    const int c = node_a.right;
+    const int balance_factor = nodes_[c].height - nodes_[b].height;
+
+    // rotate the taller child up, the taller grandchild stays under it and
+    // the shorter one moves under a
+    if (balance_factor > 1) {
+        Node& node_c = nodes_[c];
+        const int f = node_c.left;
+        const int g = node_c.right;
+
+        node_c.left = a;
+        node_c.parent = node_a.parent;
+        node_a.parent = c;
+        if (node_c.parent == k_null_node) {
+            root_ = c;
+        }
+        else {
+            replace_child(node_c.parent, a, c);
+        }
+
+        const int taller = nodes_[f].height > nodes_[g].height ? f : g;
+        const int shorter = taller == f ? g : f;
+        node_c.right = taller;
+        node_a.right = shorter;
+        nodes_[shorter].parent = a;
+        node_a.bounds = nodes_[b].bounds.merged(nodes_[shorter].bounds);
+        node_c.bounds = node_a.bounds.merged(nodes_[taller].bounds);
+        node_a.height = 1 + std::max(nodes_[b].height, nodes_[shorter].height);
+        node_c.height = 1 + std::max(node_a.height, nodes_[taller].height);
+        return c;
+    }
+
+    if (balance_factor < -1) {
+        Node& node_b = nodes_[b];
+        const int d = node_b.left;
+        const int e = node_b.right;
+
+        node_b.left = a;
+        node_b.parent = node_a.parent;
+        node_a.parent = b;
+        if (node_b.parent == k_null_node) {
+            root_ = b;
+        }
+        else {
+            replace_child(node_b.parent, a, b);
+        }
+
+        const int taller = nodes_[d].height > nodes_[e].height ? d : e;
+        const int shorter = taller == d ? e : d;
+        node_b.right = taller;
+        node_a.left = shorter;
+        nodes_[shorter].parent = a;
+        node_a.bounds = nodes_[c].bounds.merged(nodes_[shorter].bounds);
+        node_b.bounds = node_a.bounds.merged(nodes_[taller].bounds);
+        node_a.height = 1 + std::max(nodes_[c].height, nodes_[shorter].height);
+        node_b.height = 1 + std::max(node_a.height, nodes_[taller].height);
+        return b;
+    }
+
+    return a;
+}
+
+auto AabbTree::replace_child(int parent, int old_child, int new_child) -> void
+{
+    if (nodes_[parent].left == old_child) {
+        nodes_[parent].left = new_child;
+    }
+    else {
+        nodes_[parent].right = new_child;
+    }
+}
+
+auto AabbTree::validate_node(int node) const -> bool
+{
+    const Node& current = nodes_[node];
+    if (current.is_leaf()) {
+        return current.right == k_null_node && current.height == 0 && entity_to_leaf_[current.entity_id] == node;
+    }
+    const Node& left = nodes_[current.left];
+    const Node& right = nodes_[current.right];
+    return left.parent == node && right.parent == node
+        && current.height == 1 + std::max(left.height, right.height)
+        && std::abs(left.height - right.height) <= 1
+        && current.bounds.contains(left.bounds) && current.bounds.contains(right.bounds)
+        && validate_node(current.left) && validate_node(current.right);
+}
+
+#if defined(NOT_DOOM_SSE)
+auto AabbTree::intersect_ray_packet(const Aabb& bounds, const RayPacket& packet,
+    std::array<float, RayPacket::k_size>& distances) -> int
+{
+    const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.x), _mm_loadu_ps(packet.origin_x.data())),
+        _mm_loadu_ps(packet.inverse_direction_x.data()));
+    const __m128 tx2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.max.x), _mm_loadu_ps(packet.origin_x.data())),
+        _mm_loadu_ps(packet.inverse_direction_x.data()));
+    const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.y), _mm_loadu_ps(packet.origin_y.data())),
+        _mm_loadu_ps(packet.inverse_direction_y.data()));
+    const __m128 ty2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.max.y), _mm_loadu_ps(packet.origin_y.data())),
+        _mm_loadu_ps(packet.inverse_direction_y.data()));
+    const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.z), _mm_loadu_ps(packet.origin_z.data())),
+        _mm_loadu_ps(packet.inverse_direction_z.data()));
+    const __m128 tz2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.max.z), _mm_loadu_ps(packet.origin_z.data())),
+        _mm_loadu_ps(packet.inverse_direction_z.data()));
+    const __m128 t_min = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)), _mm_min_ps(tz1, tz2));
+    const __m128 t_max = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)), _mm_max_ps(tz1, tz2));
+    const __m128 distance = _mm_max_ps(t_min, _mm_setzero_ps());
+    const __m128 hits = _mm_and_ps(
+        _mm_cmpge_ps(t_max, distance), _mm_cmple_ps(distance, _mm_loadu_ps(packet.max_distance.data())));
+    _mm_storeu_ps(distances.data(), distance);
+    return _mm_movemask_ps(hits);
+}
+#else
+auto AabbTree::intersect_ray_packet(const Aabb& bounds, const RayPacket& packet,
+    std::array<float, RayPacket::k_size>& distances) -> int
+{
+    int lane_mask{0};
+    for (size_t lane = 0; lane < RayPacket::k_size; lane++) {
+        const Vector3f origin{packet.origin_x[lane], packet.origin_y[lane], packet.origin_z[lane]};
+        const Vector3f inverse_direction{
+            packet.inverse_direction_x[lane], packet.inverse_direction_y[lane], packet.inverse_direction_z[lane]};
+        if (intersect_ray(bounds, origin, inverse_direction, packet.max_distance[lane], distances[lane])) {
+            lane_mask |= 1 << lane;
+        }
+    }
+    return lane_mask;
+}
+#endif
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Aabb.hpp"
+#include "Frustum.hpp"
+#include "Vector3.hpp"
+
+// four rays laid out by component so they can be tested against a node at once
+struct RayPacket {
+    static constexpr size_t k_size = 4;
+
+    std::array<float, k_size> origin_x;
+    std::array<float, k_size> origin_y;
+    std::array<float, k_size> origin_z;
+    // see AabbTree::get_inverse_direction
+    std::array<float, k_size> inverse_direction_x;
+    std::array<float, k_size> inverse_direction_y;
+    std::array<float, k_size> inverse_direction_z;
+    // lanes with a negative max distance are unused or finished
+    std::array<float, k_size> max_distance;
+};
+
+// Dynamic bounding volume hierarchy keyed by entity id. Leaves store fattened
+// bounds so small movements do not touch the tree, and the tree is kept
+// balanced with rotations so queries stay logarithmic however the entities
+// are distributed.
+class AabbTree {
+public:
+    // how far leaf bounds are extended past the bounds of the entity
+    static constexpr float k_fat_margin = 0.1f;
+
+    AabbTree();
+
+    // Inserts the entity if it is not in the tree yet. Returns true if the
+    // tree structure changed, false if the fat bounds still contain bounds.
+    auto update(int entity_id, const Aabb& bounds) -> bool;
+    auto remove(int entity_id) -> void;
+    auto contains(int entity_id) const -> bool;
+    auto get_fat_bounds(int entity_id) const -> const Aabb&;
+    auto get_height() const -> int;
+    // checks parent links, heights and bounds of every node, for debugging and tests
+    auto validate() const -> bool;
+
+    // Calls callback(entity_id) for every entity whose fat bounds overlap
+    // bounds. Traversal stops when the callback returns false.
+    template<typename TCallback>
+    auto query(const Aabb& bounds, TCallback&& callback) const -> void
+    {
+        traverse([&bounds](const Aabb& node_bounds) { return node_bounds.overlaps(bounds); },
+            [&callback](int entity_id) { return callback(entity_id); });
+    }
+
+    // same as query but for entities intersecting frustum
+    template<typename TCallback>
+    auto query(const Frustum& frustum, TCallback&& callback) const -> void
+    {
+        traverse([&frustum](const Aabb& node_bounds) { return frustum.intersects(node_bounds); },
+            [&callback](int entity_id) { return callback(entity_id); });
+    }
+
+    // Calls callback(entity_id, distance) for every entity whose fat bounds
+    // the ray enters before max_distance, where distance is the entry
+    // distance along direction. direction must be normalized. The callback
+    // returns the new max distance, so returning the distance of a confirmed
+    // hit finds the closest hit, and returning 0 stops the traversal.
+    template<typename TCallback>
+    auto raycast(const Vector3f& origin, const Vector3f& direction, float max_distance, TCallback&& callback) const
+        -> void
+    {
+        sphere_cast(origin, 0.0f, direction, max_distance, std::forward<TCallback>(callback));
+    }
+
+    // Same as raycast for a sphere of radius centered on the ray, the fat
+    // bounds are grown by radius before they are tested.
+    template<typename TCallback>
+    auto sphere_cast(const Vector3f& origin, float radius, const Vector3f& direction, float max_distance,
+        TCallback&& callback) const -> void
+    {
+        if (root_ == k_null_node) {
+            return;
+        }
+        const Vector3f inverse_direction{
+            get_inverse_direction(direction.x), get_inverse_direction(direction.y), get_inverse_direction(direction.z)};
+        const Vector3f grow{radius, radius, radius};
+        std::array<int, k_max_stack_size> stack;
+        size_t stack_size{0};
+        stack[stack_size++] = root_;
+        while (stack_size > 0) {
+            const Node& node = nodes_[stack[--stack_size]];
+            const Aabb bounds{node.bounds.min - grow, node.bounds.max + grow};
+            float distance;
+            if (!intersect_ray(bounds, origin, inverse_direction, max_distance, distance)) {
+                continue;
+            }
+            if (node.is_leaf()) {
+                max_distance = callback(node.entity_id, distance);
+                if (max_distance <= 0) {
+                    return;
+                }
+                continue;
+            }
+            assert(stack_size + 2 <= k_max_stack_size && "Tree is too deep");
+            stack[stack_size++] = node.left;
+            stack[stack_size++] = node.right;
+        }
+    }
+
+    // Same as raycast for the rays of packet, traversing the tree once for
+    // all of them. Calls callback(lane, entity_id, distance) and stores the
+    // returned max distance in the lane, returning 0 stops the lane.
+    template<typename TCallback>
+    auto raycast(RayPacket& packet, TCallback&& callback) const -> void
+    {
+        if (root_ == k_null_node) {
+            return;
+        }
+        std::array<int, k_max_stack_size> stack;
+        size_t stack_size{0};
+        stack[stack_size++] = root_;
+        std::array<float, RayPacket::k_size> distances;
+        while (stack_size > 0) {
+            const Node& node = nodes_[stack[--stack_size]];
+            int lane_mask = intersect_ray_packet(node.bounds, packet, distances);
+            if (lane_mask == 0) {
+                continue;
+            }
+            if (node.is_leaf()) {
+                for (size_t lane = 0; lane_mask != 0; lane++, lane_mask >>= 1) {
+                    if ((lane_mask & 1) == 0) {
+                        continue;
+                    }
+                    const float max_distance = callback(lane, node.entity_id, distances[lane]);
+                    packet.max_distance[lane] = max_distance > 0 ? max_distance : -1.0f;
+                }
+                continue;
+            }
+            assert(stack_size + 2 <= k_max_stack_size && "Tree is too deep");
+            stack[stack_size++] = node.left;
+            stack[stack_size++] = node.right;
+        }
+    }
+
+    // Inverse of a direction component for the slab tests. Zero is nudged to
+    // the smallest float of its sign, otherwise a ray starting on the plane of
+    // a slab computes 0 * infinity and the NaN decides whether it hits.
+    auto static get_inverse_direction(float direction) -> float
+    {
+        return 1 / (direction == 0 ? std::copysign(std::numeric_limits<float>::min(), direction) : direction);
+    }
+
+    // slab test, distance is set to where the ray enters bounds, 0 if it starts inside
+    auto static intersect_ray(const Aabb& bounds, const Vector3f& origin, const Vector3f& inverse_direction,
+        float max_distance, float& distance) -> bool
+    {
+        const float tx1 = (bounds.min.x - origin.x) * inverse_direction.x;
+        const float tx2 = (bounds.max.x - origin.x) * inverse_direction.x;
+        const float ty1 = (bounds.min.y - origin.y) * inverse_direction.y;
+        const float ty2 = (bounds.max.y - origin.y) * inverse_direction.y;
+        const float tz1 = (bounds.min.z - origin.z) * inverse_direction.z;
+        const float tz2 = (bounds.max.z - origin.z) * inverse_direction.z;
+        const float t_min = std::fmax(std::fmax(std::fmin(tx1, tx2), std::fmin(ty1, ty2)), std::fmin(tz1, tz2));
+        const float t_max = std::fmin(std::fmin(std::fmax(tx1, tx2), std::fmax(ty1, ty2)), std::fmax(tz1, tz2));
+        distance = std::fmax(t_min, 0.0f);
+        return t_max >= distance && distance <= max_distance;
+    }
+
+    // slab test of every lane of packet, returns a mask with bit i set if lane i hits
+    auto static intersect_ray_packet(const Aabb& bounds, const RayPacket& packet,
+        std::array<float, RayPacket::k_size>& distances) -> int;
+
+private:
+    static constexpr int k_null_node = -1;
+    // the tree is balanced so its height stays far below this
+    static constexpr size_t k_max_stack_size = 256;
+
+    struct Node {
+        Aabb bounds;
+        int parent;
+        int left;
+        int right;
+        // leaves have height 0, free nodes -1
+        int height;
+        int entity_id;
+
+        auto is_leaf() const -> bool
+        {
+            return left == k_null_node;
+        }
+    };
+
+    std::vector<Node> nodes_;
+    int root_;
+    // free nodes are chained through their parent index
+    int free_list_;
+    // leaf node of every entity id, k_null_node if not in the tree
+    std::vector<int> entity_to_leaf_;
+
+    auto allocate_node() -> int;
+    auto free_node(int node) -> void;
+    auto insert_leaf(int leaf) -> void;
+    auto remove_leaf(int leaf) -> void;
+    // refits bounds and heights from node to the root, rebalancing on the way
+    auto refit_ancestors(int node) -> void;
+    // rotates node's children if their heights differ by more than one, returns the new subtree root
+    auto balance(int node) -> int;
+    auto replace_child(int parent, int old_child, int new_child) -> void;
+    auto validate_node(int node) const -> bool;
+
+    template<typename TNodeTest, typename TLeafCallback>
+    auto traverse(TNodeTest&& node_test, TLeafCallback&& leaf_callback) const -> void
+    {
+        if (root_ == k_null_node) {
+            return;
+        }
+        std::array<int, k_max_stack_size> stack;
+        size_t stack_size{0};
+        stack[stack_size++] = root_;
+        while (stack_size > 0) {
+            const Node& node = nodes_[stack[--stack_size]];
+            if (!node_test(node.bounds)) {
+                continue;
+            }
+            if (node.is_leaf()) {
+                if (!leaf_callback(node.entity_id)) {
+                    return;
+                }
+                continue;
+            }
+            assert(stack_size + 2 <= k_max_stack_size && "Tree is too deep");
+            stack[stack_size++] = node.left;
+            stack[stack_size++] = node.right;
+        }
+    }
+};
@@ -0,0 +1,225 @@
+#include "BakedMesh.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifdef WIN32_LEAN_AND_MEAN
+#include "windows.h"
+#else
+#define WIN32_LEAN_AND_MEAN
+#include "windows.h"
+#undef WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "Logger.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+// maps the whole file read only, nothing if it can not be opened or is empty
+auto map_file(const std::filesystem::path& path) -> std::optional<std::span<const std::byte>>
+{
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+    // the view keeps the file mapped after both handles are closed
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return std::nullopt;
+    }
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+    return std::span{static_cast<const std::byte*>(data), static_cast<size_t>(file_size.QuadPart)};
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return std::nullopt;
+    }
+    struct stat file_status;
+    if (fstat(file, &file_status) != 0 || file_status.st_size == 0) {
+        close(file);
+        return std::nullopt;
+    }
+    // the mapping stays valid after the descriptor is closed
+    const auto size = static_cast<size_t>(file_status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+    return std::span{static_cast<const std::byte*>(data), size};
+#endif // _WIN32
+}
+
+auto unmap_file(std::span<const std::byte> data) -> void
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data.data());
+#else
+    munmap(const_cast<std::byte*>(data.data()), data.size());
+#endif // _WIN32
+}
+} // namespace
+
+auto BakedMesh::SourceStamp::of(const std::filesystem::path& source_path) -> std::optional<SourceStamp>
+{
+    std::error_code error;
+    const auto size = std::filesystem::file_size(source_path, error);
+    if (error) {
+        return std::nullopt;
+    }
+    const auto write_time = std::filesystem::last_write_time(source_path, error);
+    if (error) {
+        return std::nullopt;
+    }
+    return SourceStamp{
+        .size = static_cast<uint64_t>(size),
+        .write_time = static_cast<int64_t>(write_time.time_since_epoch().count()),
+    };
+}
+
+auto BakedMesh::write(const std::filesystem::path& path, const Mesh& mesh, Mesh::PositionFormat position_format,
+    const SourceStamp& source_stamp) -> bool
+{
+    const std::vector<std::byte> vertices = mesh.pack_vertices(position_format);
+    const std::vector<std::byte> indices = mesh.pack_indices();
+    const Aabb bounds = mesh.local_bounds();
+    const Mesh::BoundingSphere bounding_sphere = mesh.local_bounding_sphere();
+    const Header header{
+        .magic = k_magic,
+        .version = k_version,
+        .position_format = static_cast<uint32_t>(position_format),
+        .vertex_count = static_cast<uint32_t>(mesh.vertices.size() / 3),
+        .index_count = static_cast<uint32_t>(mesh.indices.size()),
+        .index_type = mesh.get_index_type(),
+        .source_size = source_stamp.size,
+        .source_write_time = source_stamp.write_time,
+        .bounds_min = {bounds.min.x, bounds.min.y, bounds.min.z},
+        .bounds_max = {bounds.max.x, bounds.max.y, bounds.max.z},
+        .bounding_sphere = {bounding_sphere.center.x, bounding_sphere.center.y, bounding_sphere.center.z,
+            bounding_sphere.radius},
+    };
+
+    std::ofstream file{path, std::ios_base::binary | std::ios_base::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size()));
+    file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size()));
+    file.close();
+    if (!file) [[unlikely]] {
+        Logger::get_default()->warning(std::format("Could not write baked mesh {}.", path.string()));
+        // a partly written file is rejected by open anyway
+        return false;
+    }
+    return true;
+}
+
+auto BakedMesh::open(const std::filesystem::path& path, Mesh::PositionFormat position_format,
+    const SourceStamp& source_stamp) -> std::optional<BakedMesh>
+{
+    const auto data = map_file(path);
+    if (!data) {
+        return std::nullopt;
+    }
+    Header header;
+    if (data->size() < sizeof(header)) [[unlikely]] {
+        unmap_file(*data);
+        return std::nullopt;
+    }
+    std::memcpy(&header, data->data(), sizeof(header));
+    const size_t expected_size = sizeof(header)
+        + static_cast<size_t>(header.vertex_count) * Mesh::get_vertex_layout(position_format).stride
+        + static_cast<size_t>(header.index_count) * Mesh::get_index_size(header.index_type);
+    const bool is_current = header.magic == k_magic && header.version == k_version
+        && header.position_format == static_cast<uint32_t>(position_format)
+        && (header.index_type == GL_UNSIGNED_SHORT || header.index_type == GL_UNSIGNED_INT)
+        && SourceStamp{header.source_size, header.source_write_time} == source_stamp
+        && data->size() == expected_size;
+    if (!is_current) {
+        unmap_file(*data);
+        return std::nullopt;
+    }
+    return BakedMesh{*data, header};
+}
+
+BakedMesh::BakedMesh(std::span<const std::byte> data, const Header& header) :
+    data_{data}, header_{header}
+{
+}
+
+BakedMesh::~BakedMesh()
+{
+    unmap();
+}
+
+BakedMesh::BakedMesh(BakedMesh&& other) noexcept :
+    data_{std::exchange(other.data_, {})}, header_{other.header_}
+{
+}
+
+auto BakedMesh::operator=(BakedMesh&& other) noexcept -> BakedMesh&
+{
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, {});
+        header_ = other.header_;
+    }
+    return *this;
+}
+
+auto BakedMesh::get_vertices() const -> std::span<const std::byte>
+{
+    return data_.subspan(sizeof(Header), data_.size() - sizeof(Header) - get_indices().size());
+}
+
+auto BakedMesh::get_indices() const -> std::span<const std::byte>
+{
+    return data_.last(header_.index_count * Mesh::get_index_size(header_.index_type));
+}
+
+auto BakedMesh::get_index_type() const -> GLenum
+{
+    return header_.index_type;
+}
+
+auto BakedMesh::get_bounds() const -> Aabb
+{
+    return {{header_.bounds_min[0], header_.bounds_min[1], header_.bounds_min[2]},
+        {header_.bounds_max[0], header_.bounds_max[1], header_.bounds_max[2]}};
+}
+
+auto BakedMesh::get_bounding_sphere() const -> Mesh::BoundingSphere
+{
+    return {{header_.bounding_sphere[0], header_.bounding_sphere[1], header_.bounding_sphere[2]},
+        header_.bounding_sphere[3]};
+}
+
+auto BakedMesh::unmap() -> void
+{
+    if (!data_.empty()) {
+        unmap_file(data_);
+        data_ = {};
+    }
+}
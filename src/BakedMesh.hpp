@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+#include "Aabb.hpp"
+#include "Mesh.hpp"
+
+// Mesh stored in a binary file exactly as the mesh arena uploads it, a
+// header followed by the packed vertices and the indices. The file is mapped
+// instead of read, so loading it does no parsing and its data is handed to
+// the driver straight from the mapping.
+class BakedMesh {
+public:
+    // size and modification time of the file a mesh was imported from, a baked mesh is stale once it changes
+    struct SourceStamp {
+        uint64_t size;
+        int64_t write_time;
+
+        auto static of(const std::filesystem::path& source_path) -> std::optional<SourceStamp>;
+        auto operator==(const SourceStamp&) const -> bool = default;
+    };
+
+    // Packs mesh in position_format and writes it to path, false if the file
+    // could not be written.
+    auto static write(const std::filesystem::path& path, const Mesh& mesh, Mesh::PositionFormat position_format,
+        const SourceStamp& source_stamp) -> bool;
+    // Maps a baked mesh, nothing if the file is missing or damaged, or was
+    // baked from another version of the source or in another format.
+    auto static open(const std::filesystem::path& path, Mesh::PositionFormat position_format,
+        const SourceStamp& source_stamp) -> std::optional<BakedMesh>;
+
+    ~BakedMesh();
+    BakedMesh(BakedMesh&& other) noexcept;
+    auto operator=(BakedMesh&& other) noexcept -> BakedMesh&;
+    BakedMesh(const BakedMesh&) = delete;
+    auto operator=(const BakedMesh&) -> BakedMesh& = delete;
+
+    // packed in the layout of the position format the mesh was baked in
+    auto get_vertices() const -> std::span<const std::byte>;
+    // in the width of get_index_type
+    auto get_indices() const -> std::span<const std::byte>;
+    auto get_index_type() const -> GLenum;
+    auto get_bounds() const -> Aabb;
+    auto get_bounding_sphere() const -> Mesh::BoundingSphere;
+
+private:
+    // "MESH" read as a little endian integer
+    static constexpr uint32_t k_magic = 0x4853454d;
+    // bumped whenever the layout of the file changes
+    static constexpr uint32_t k_version = 2;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t position_format;
+        uint32_t vertex_count;
+        uint32_t index_count;
+        // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+        uint32_t index_type;
+        uint64_t source_size;
+        int64_t source_write_time;
+        std::array<float, 3> bounds_min;
+        std::array<float, 3> bounds_max;
+        // center and radius
+        std::array<float, 4> bounding_sphere;
+    };
+    // keeps the vertices after the header aligned for any position format
+    static_assert(sizeof(Header) % 16 == 0);
+
+    // the whole mapped file
+    std::span<const std::byte> data_;
+    Header header_;
+
+    BakedMesh(std::span<const std::byte> data, const Header& header);
+
+    auto unmap() -> void;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+// Optional shape override for entities taking part in collision. Entities with
+// a mesh but no ColliderComponent collide as boxes fitted to the mesh.
+struct ColliderComponent {
+    enum class Shape {
+        box,
+        sphere
+    };
+
+    int entity_id;
+    Shape shape;
+    // 0 for fully inelastic, 1 for fully elastic collisions
+    float restitution;
+};
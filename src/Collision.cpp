@@ -0,0 +1,270 @@
+#include "Collision.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace
+{
+// rotations this close to identity are treated as axis aligned
+constexpr float k_axis_aligned_epsilon = 1e-6f;
+// cross product axes shorter than this come from nearly parallel edges and are skipped
+constexpr float k_parallel_epsilon = 1e-6f;
+// ray direction components smaller than this are treated as parallel to the slab
+constexpr float k_ray_parallel_epsilon = 1e-8f;
+
+auto get_axes(const Quaternionf& rotation) -> std::array<Vector3f, 3>
+{
+    return {
+        rotation.rotate_point({1, 0, 0}),
+        rotation.rotate_point({0, 1, 0}),
+        rotation.rotate_point({0, 0, 1}),
+    };
+}
+
+auto flipped(std::optional<collision::Contact> contact) -> std::optional<collision::Contact>
+{
+    if (contact) {
+        contact->normal = -contact->normal;
+    }
+    return contact;
+}
+} // namespace
+
+auto collision::make_shape(ColliderComponent::Shape type, const Aabb& local_bounds, const TransformComponent& transform)
+    -> Shape
+{
+    const Vector3f half_extents = local_bounds.half_extents().element_wise(transform.scale);
+    const Vector3f abs_half_extents{std::fabs(half_extents.x), std::fabs(half_extents.y), std::fabs(half_extents.z)};
+    return {
+        .type = type,
+        .center = transform.rotation.rotate_point(local_bounds.center().element_wise(transform.scale))
+            + transform.position,
+        .half_extents = abs_half_extents,
+        .rotation = transform.rotation,
+        .radius = std::max({abs_half_extents.x, abs_half_extents.y, abs_half_extents.z}),
+        .is_axis_aligned = 1 - std::fabs(transform.rotation.w) < k_axis_aligned_epsilon,
+    };
+}
+
+auto collision::collide(const Shape& a, const Shape& b) -> std::optional<Contact>
+{
+    using enum ColliderComponent::Shape;
+    if (a.type == sphere && b.type == sphere) {
+        return collide_sphere_sphere(a, b);
+    }
+    if (a.type == box && b.type == sphere) {
+        return collide_box_sphere(a, b);
+    }
+    if (a.type == sphere && b.type == box) {
+        return flipped(collide_box_sphere(b, a));
+    }
+    if (a.is_axis_aligned && b.is_axis_aligned) [[likely]] {
+        return collide_aabb_aabb(a, b);
+    }
+    return collide_obb_obb(a, b);
+}
+
+auto collision::collide_aabb_aabb(const Shape& a, const Shape& b) -> std::optional<Contact>
+{
+    const Vector3f offset = b.center - a.center;
+    const std::array<float, 3> overlaps{
+        a.half_extents.x + b.half_extents.x - std::fabs(offset.x),
+        a.half_extents.y + b.half_extents.y - std::fabs(offset.y),
+        a.half_extents.z + b.half_extents.z - std::fabs(offset.z),
+    };
+    if (overlaps[0] < 0 || overlaps[1] < 0 || overlaps[2] < 0) {
+        return std::nullopt;
+    }
+
+    // separate along the axis of least penetration
+    const auto min_it = std::min_element(overlaps.begin(), overlaps.end());
+    const std::array<float, 3> offsets{offset.x, offset.y, offset.z};
+    const size_t axis = std::distance(overlaps.begin(), min_it);
+    const float sign = offsets[axis] < 0 ? -1.0f : 1.0f;
+    Vector3f normal{};
+    (axis == 0 ? normal.x : axis == 1 ? normal.y : normal.z) = sign;
+    return Contact{.normal = normal, .penetration = *min_it};
+}
+
+auto collision::collide_sphere_sphere(const Shape& a, const Shape& b) -> std::optional<Contact>
+{
+    const Vector3f offset = b.center - a.center;
+    const float distance_squared = offset.dot(offset);
+    const float radii = a.radius + b.radius;
+    if (distance_squared > radii * radii) {
+        return std::nullopt;
+    }
+    const float distance = std::sqrt(distance_squared);
+    // concentric spheres can be pushed apart in any direction
+    const Vector3f normal = distance > 0 ? offset / distance : Vector3f{0, 1, 0};
+    return Contact{.normal = normal, .penetration = radii - distance};
+}
+
+auto collision::collide_box_sphere(const Shape& box, const Shape& sphere) -> std::optional<Contact>
+{
+    // work in the local space of the box
+    const Quaternionf inverse_rotation = box.rotation.inverse();
+    const Vector3f local_center = inverse_rotation.rotate_point(sphere.center - box.center);
+    const Vector3f& extents = box.half_extents;
+    const Vector3f closest{
+        std::clamp(local_center.x, -extents.x, extents.x),
+        std::clamp(local_center.y, -extents.y, extents.y),
+        std::clamp(local_center.z, -extents.z, extents.z),
+    };
+    const Vector3f offset = local_center - closest;
+    const float distance_squared = offset.dot(offset);
+    if (distance_squared > sphere.radius * sphere.radius) {
+        return std::nullopt;
+    }
+
+    if (distance_squared > 0) [[likely]] {
+        const float distance = std::sqrt(distance_squared);
+        return Contact{
+            .normal = box.rotation.rotate_point(offset / distance),
+            .penetration = sphere.radius - distance,
+        };
+    }
+
+    // sphere center is inside the box, push it out through the nearest face
+    const std::array<float, 3> face_distances{
+        extents.x - std::fabs(local_center.x),
+        extents.y - std::fabs(local_center.y),
+        extents.z - std::fabs(local_center.z),
+    };
+    const auto min_it = std::min_element(face_distances.begin(), face_distances.end());
+    const size_t axis = std::distance(face_distances.begin(), min_it);
+    const std::array<float, 3> coordinates{local_center.x, local_center.y, local_center.z};
+    Vector3f local_normal{};
+    (axis == 0 ? local_normal.x : axis == 1 ? local_normal.y : local_normal.z) = coordinates[axis] < 0 ? -1.0f : 1.0f;
+    return Contact{
+        .normal = box.rotation.rotate_point(local_normal),
+        .penetration = *min_it + sphere.radius,
+    };
+}
+
+auto collision::collide_obb_obb(const Shape& a, const Shape& b) -> std::optional<Contact>
+{
+    const std::array<Vector3f, 3> axes_a = get_axes(a.rotation);
+    const std::array<Vector3f, 3> axes_b = get_axes(b.rotation);
+    const std::array<float, 3> extents_a{a.half_extents.x, a.half_extents.y, a.half_extents.z};
+    const std::array<float, 3> extents_b{b.half_extents.x, b.half_extents.y, b.half_extents.z};
+    const Vector3f offset = b.center - a.center;
+
+    float min_score = std::numeric_limits<float>::max();
+    float min_penetration{0};
+    Vector3f min_axis{};
+    // returns false if axis separates the boxes
+    const auto test_axis = [&](Vector3f axis, float bias) -> bool {
+        const float length = axis.length();
+        if (length < k_parallel_epsilon) {
+            return true;
+        }
+        axis /= length;
+        float projected_a = 0;
+        float projected_b = 0;
+        for (int i = 0; i < 3; i++) {
+            projected_a += extents_a[i] * std::fabs(axes_a[i].dot(axis));
+            projected_b += extents_b[i] * std::fabs(axes_b[i].dot(axis));
+        }
+        const float distance = offset.dot(axis);
+        const float penetration = projected_a + projected_b - std::fabs(distance);
+        if (penetration < 0) {
+            return false;
+        }
+        if (penetration + bias < min_score) {
+            min_score = penetration + bias;
+            min_penetration = penetration;
+            min_axis = distance < 0 ? -axis : axis;
+        }
+        return true;
+    };
+
+    for (const Vector3f& axis : axes_a) {
+        if (!test_axis(axis, 0)) {
+            return std::nullopt;
+        }
+    }
+    for (const Vector3f& axis : axes_b) {
+        if (!test_axis(axis, 0)) {
+            return std::nullopt;
+        }
+    }
+    // edge axes are slightly penalized so resting boxes separate along face normals
+    constexpr float edge_bias = 1e-3f;
+    for (const Vector3f& axis_a : axes_a) {
+        for (const Vector3f& axis_b : axes_b) {
+            if (!test_axis(axis_a.cross(axis_b), edge_bias)) {
+                return std::nullopt;
+            }
+        }
+    }
+    return Contact{.normal = min_axis, .penetration = min_penetration};
+}
+
+auto collision::raycast(const Shape& shape, const Vector3f& origin, const Vector3f& direction, float max_distance)
+    -> std::optional<RayHit>
+{
+    if (shape.type == ColliderComponent::Shape::sphere) {
+        const Vector3f offset = origin - shape.center;
+        const float b = offset.dot(direction);
+        const float c = offset.dot(offset) - shape.radius * shape.radius;
+        if (c <= 0) {
+            return RayHit{.distance = 0, .normal = -direction};
+        }
+        const float discriminant = b * b - c;
+        // starts outside and points away, or misses
+        if (b > 0 || discriminant < 0) {
+            return std::nullopt;
+        }
+        const float distance = -b - std::sqrt(discriminant);
+        if (distance > max_distance) {
+            return std::nullopt;
+        }
+        return RayHit{.distance = distance, .normal = (offset + direction * distance) / shape.radius};
+    }
+
+    // boxes are intersected in their local space where they are axis aligned
+    const Quaternionf inverse_rotation = shape.rotation.inverse();
+    const Vector3f local_offset
+        = shape.is_axis_aligned ? origin - shape.center : inverse_rotation.rotate_point(origin - shape.center);
+    const Vector3f local_direction = shape.is_axis_aligned ? direction : inverse_rotation.rotate_point(direction);
+    const std::array<float, 3> offsets{local_offset.x, local_offset.y, local_offset.z};
+    const std::array<float, 3> directions{local_direction.x, local_direction.y, local_direction.z};
+    const std::array<float, 3> half_extents{shape.half_extents.x, shape.half_extents.y, shape.half_extents.z};
+
+    float entry = 0;
+    float exit = max_distance;
+    // axis of the face the ray enters through, none if it starts inside
+    int entry_axis = -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (std::fabs(directions[axis]) < k_ray_parallel_epsilon) {
+            if (std::fabs(offsets[axis]) > half_extents[axis]) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        const float inverse_direction = 1 / directions[axis];
+        const float near = (-std::copysign(half_extents[axis], directions[axis]) - offsets[axis]) * inverse_direction;
+        const float far = (std::copysign(half_extents[axis], directions[axis]) - offsets[axis]) * inverse_direction;
+        if (near > entry) {
+            entry = near;
+            entry_axis = axis;
+        }
+        exit = std::min(exit, far);
+        if (entry > exit) {
+            return std::nullopt;
+        }
+    }
+
+    if (entry_axis == -1) {
+        return RayHit{.distance = 0, .normal = -direction};
+    }
+    std::array<float, 3> local_normal{0, 0, 0};
+    local_normal[entry_axis] = directions[entry_axis] > 0 ? -1.0f : 1.0f;
+    const Vector3f normal{local_normal[0], local_normal[1], local_normal[2]};
+    return RayHit{.distance = entry, .normal = shape.is_axis_aligned ? normal : shape.rotation.rotate_point(normal)};
+}
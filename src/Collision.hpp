@@ -0,0 +1,55 @@
+#pragma once
+
+#include <optional>
+
+#include "Aabb.hpp"
+#include "ColliderComponent.hpp"
+#include "Quaternion.hpp"
+#include "TransformComponent.hpp"
+#include "Vector3.hpp"
+
+namespace collision
+{
+// collision shape of an entity in world space
+struct Shape {
+    ColliderComponent::Shape type;
+    Vector3f center;
+    // box only
+    Vector3f half_extents;
+    Quaternionf rotation;
+    // sphere only
+    float radius;
+    // box with identity rotation, can use the cheaper aabb test
+    bool is_axis_aligned;
+};
+
+struct Contact {
+    // unit vector pointing from the first shape to the second
+    Vector3f normal;
+    float penetration;
+};
+
+struct RayHit {
+    float distance;
+    // unit normal of the surface at the hit point, facing against the ray
+    Vector3f normal;
+};
+
+// fits a shape of given type to local_bounds transformed by transform
+auto make_shape(ColliderComponent::Shape type, const Aabb& local_bounds, const TransformComponent& transform) -> Shape;
+
+// picks the test matching the shape types, returns nothing if they do not touch
+auto collide(const Shape& a, const Shape& b) -> std::optional<Contact>;
+
+auto collide_aabb_aabb(const Shape& a, const Shape& b) -> std::optional<Contact>;
+auto collide_sphere_sphere(const Shape& a, const Shape& b) -> std::optional<Contact>;
+// normal points from the box to the sphere
+auto collide_box_sphere(const Shape& box, const Shape& sphere) -> std::optional<Contact>;
+// separating axis test over the face normals of both boxes and their edge cross products
+auto collide_obb_obb(const Shape& a, const Shape& b) -> std::optional<Contact>;
+
+// Closest point where the ray enters shape before max_distance. direction
+// must be normalized. Rays starting inside the shape hit at distance 0.
+auto raycast(const Shape& shape, const Vector3f& origin, const Vector3f& direction, float max_distance)
+    -> std::optional<RayHit>;
+} // namespace collision
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <vector>
 
 class IComponentVector {
@@ -11,7 +12,7 @@ public:
 template<typename T>
 class ComponentVector : public IComponentVector {
 public:
-    ComponentVector() : component_vector_()
+    ComponentVector() : component_vector_(), entity_to_index_()
     {
     }
 
@@ -25,16 +26,32 @@ public:
         return component_vector_.end();
     }
 
+    auto size() const -> typename std::vector<T>::size_type
+    {
+        return component_vector_.size();
+    }
+
+    // constant time lookup through the sparse entity to index table
     auto find_component(int entity_id) -> T*
     {
-        auto result = std::find_if(component_vector_.begin(), component_vector_.end(), [&](const T& component){
-            return component.entity_id == entity_id;
-        });
-        return result == component_vector_.end() ? nullptr : &(*result);
+        if (entity_id < 0 || static_cast<size_t>(entity_id) >= entity_to_index_.size()) [[unlikely]] {
+            return nullptr;
+        }
+        const int index = entity_to_index_[entity_id];
+        return index == k_no_component ? nullptr : &component_vector_[index];
     }
 
+    // an entity has at most one component of a type
     auto insert_component(const T& component) -> void
     {
+        assert(component.entity_id >= 0 && "Can not insert a component of a negative entity id");
+        assert(find_component(component.entity_id) == nullptr
+            && "Can not insert a component of an entity that already has one");
+
+        if (static_cast<size_t>(component.entity_id) >= entity_to_index_.size()) {
+            entity_to_index_.resize(component.entity_id + 1, k_no_component);
+        }
+        entity_to_index_[component.entity_id] = static_cast<int>(component_vector_.size());
         component_vector_.push_back(component);
     }
 
@@ -42,21 +59,26 @@ public:
     // it tightly packed
     auto remove_component(int entity_id) -> void
     {
-        for (typename std::vector<T>::size_type i = 0;
-             i < component_vector_.size(); i++) {
-            if (static_cast<T>(component_vector_[i]).entity_id == entity_id) {
-                component_vector_[i] =
-                    component_vector_[component_vector_.size() - 1];
-                component_vector_.pop_back();
-            }
+        if (find_component(entity_id) == nullptr) [[unlikely]] {
+            return;
         }
+        const int index = entity_to_index_[entity_id];
+        const int last_entity_id = component_vector_.back().entity_id;
+        component_vector_[index] = component_vector_.back();
+        component_vector_.pop_back();
+        entity_to_index_[last_entity_id] = index;
+        entity_to_index_[entity_id] = k_no_component;
     }
 
     auto clear() -> void
     {
         component_vector_.clear();
+        entity_to_index_.clear();
     }
 
 private:
+    static constexpr int k_no_component = -1;
     std::vector<T> component_vector_;
+    // index into component_vector_ for every entity id, k_no_component if entity has none
+    std::vector<int> entity_to_index_;
 };
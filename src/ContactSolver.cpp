@@ -0,0 +1,111 @@
+#include "ContactSolver.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace
+{
+// contacts whose normal turned further than this are solved from scratch
+constexpr float k_min_normal_alignment = 0.95f;
+
+auto apply_impulse(physics::SolverBody& a, physics::SolverBody& b, const Vector3f& impulse) -> void
+{
+    // static bodies are shared between contacts and never written to
+    if (a.inverse_mass > 0) {
+        a.velocity -= impulse * a.inverse_mass;
+    }
+    if (b.inverse_mass > 0) {
+        b.velocity += impulse * b.inverse_mass;
+    }
+}
+
+auto is_before(const physics::ContactConstraint& lhs, const physics::ContactConstraint& rhs) -> bool
+{
+    return lhs.entity_a != rhs.entity_a ? lhs.entity_a < rhs.entity_a : lhs.entity_b < rhs.entity_b;
+}
+
+// works on any range of contacts so indexed subsets are solved without copying them
+auto solve_contact_range(std::ranges::forward_range auto&& contacts, std::span<physics::SolverBody> bodies,
+    const physics::SolverSettings& settings) -> void
+{
+    using physics::ContactConstraint;
+    using physics::SolverBody;
+
+    for (ContactConstraint& contact : contacts) {
+        SolverBody& a = bodies[contact.body_a];
+        SolverBody& b = bodies[contact.body_b];
+        const float inverse_mass_sum = a.inverse_mass + b.inverse_mass;
+        contact.effective_mass = inverse_mass_sum > 0 ? 1 / inverse_mass_sum : 0;
+
+        const float normal_velocity = (b.velocity - a.velocity).dot(contact.normal);
+        contact.velocity_bias = normal_velocity < -settings.restitution_threshold
+            ? -contact.restitution * normal_velocity
+            : 0;
+
+        contact.normal_impulse *= settings.warm_start_factor;
+        apply_impulse(a, b, contact.normal * contact.normal_impulse);
+    }
+
+    for (int iteration = 0; iteration < settings.iterations; iteration++) {
+        for (ContactConstraint& contact : contacts) {
+            SolverBody& a = bodies[contact.body_a];
+            SolverBody& b = bodies[contact.body_b];
+            const float normal_velocity = (b.velocity - a.velocity).dot(contact.normal);
+            const float impulse = contact.effective_mass * (contact.velocity_bias - normal_velocity);
+            // contacts can only push, clamp the accumulated impulse instead of each increment
+            const float accumulated = std::max(contact.normal_impulse + impulse, 0.0f);
+            const float applied = accumulated - contact.normal_impulse;
+            contact.normal_impulse = accumulated;
+            apply_impulse(a, b, contact.normal * applied);
+        }
+    }
+
+    // push overlapping bodies apart directly instead of adding separation velocity
+    for (const ContactConstraint& contact : contacts) {
+        SolverBody& a = bodies[contact.body_a];
+        SolverBody& b = bodies[contact.body_b];
+        const float depth = std::max(contact.penetration - settings.penetration_slop, 0.0f);
+        const Vector3f correction = contact.normal * (depth * settings.correction_factor * contact.effective_mass);
+        if (a.inverse_mass > 0) {
+            a.position_correction -= correction * a.inverse_mass;
+        }
+        if (b.inverse_mass > 0) {
+            b.position_correction += correction * b.inverse_mass;
+        }
+    }
+}
+} // namespace
+
+auto physics::warm_start_contacts(std::vector<ContactConstraint>& contacts,
+    const std::vector<ContactConstraint>& previous) -> void
+{
+    // both lists are sorted, match them with a single linear pass
+    auto previous_it = previous.begin();
+    for (ContactConstraint& contact : contacts) {
+        while (previous_it != previous.end() && is_before(*previous_it, contact)) {
+            ++previous_it;
+        }
+        if (previous_it == previous.end()) {
+            contact.normal_impulse = 0;
+            continue;
+        }
+        const bool is_same_pair
+            = previous_it->entity_a == contact.entity_a && previous_it->entity_b == contact.entity_b;
+        const bool is_aligned = previous_it->normal.dot(contact.normal) > k_min_normal_alignment;
+        contact.normal_impulse = is_same_pair && is_aligned ? previous_it->normal_impulse : 0;
+    }
+}
+
+auto physics::solve_contacts(std::span<ContactConstraint> contacts, std::span<SolverBody> bodies,
+    const SolverSettings& settings) -> void
+{
+    solve_contact_range(contacts, bodies, settings);
+}
+
+auto physics::solve_contacts(std::span<ContactConstraint> contacts, std::span<const int> indices,
+    std::span<SolverBody> bodies, const SolverSettings& settings) -> void
+{
+    solve_contact_range(
+        indices | std::views::transform([contacts](int index) -> ContactConstraint& { return contacts[index]; }),
+        bodies, settings);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Vector3.hpp"
+
+namespace physics
+{
+// state of a body as seen by the solver, static bodies have zero inverse mass
+struct SolverBody {
+    Vector3f velocity;
+    // accumulated position change from penetration recovery
+    Vector3f position_correction;
+    float inverse_mass;
+};
+
+struct ContactConstraint {
+    // entity ids identify the contact across frames, entity_a < entity_b
+    int entity_a;
+    int entity_b;
+    // indices into the solver bodies
+    int body_a;
+    int body_b;
+    // points from a to b
+    Vector3f normal;
+    float penetration;
+    float restitution;
+    // accumulated impulse along normal, carried over to warm start the next frame
+    float normal_impulse;
+    // computed by the solver
+    float effective_mass;
+    float velocity_bias;
+};
+
+struct SolverSettings {
+    int iterations = 8;
+    // fraction of last frame's impulse applied before iterating
+    float warm_start_factor = 0.8f;
+    // approach speeds below this do not bounce
+    float restitution_threshold = 0.01f;
+    // penetration allowed without correction, avoids jitter of resting contacts
+    float penetration_slop = 0.01f;
+    // fraction of the penetration removed per step
+    float correction_factor = 0.8f;
+};
+
+// Copies accumulated impulses of contacts that persist from previous into
+// contacts. Both have to be sorted by entity ids.
+auto warm_start_contacts(std::vector<ContactConstraint>& contacts, const std::vector<ContactConstraint>& previous)
+    -> void;
+
+// Sequential impulse solver over the linear velocities of bodies. Contacts
+// are solved in the order given so results are deterministic.
+auto solve_contacts(std::span<ContactConstraint> contacts, std::span<SolverBody> bodies,
+    const SolverSettings& settings) -> void;
+// Solves only contacts[indices[i]] in the order of indices. Calls on disjoint
+// sets of dynamic bodies, like separate islands, can run concurrently.
+auto solve_contacts(std::span<ContactConstraint> contacts, std::span<const int> indices,
+    std::span<SolverBody> bodies, const SolverSettings& settings) -> void;
+} // namespace physics
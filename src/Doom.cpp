@@ -1,12 +1,16 @@
 #include "Doom.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <format>
 #include <functional>
-#include <iterator>
+#include <limits>
 #include <numbers>
-#include <numeric>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -20,23 +24,46 @@
 #include <SDL_scancode.h>
 #include <SDL_video.h>
 
+#include "ColliderComponent.hpp"
 #include "ComponentManager.hpp"
 #include "ComponentVector.hpp"
 #include "EntityManager.hpp"
+#include "Frustum.hpp"
+#include "GpuCuller.hpp"
+#include "GpuRingBuffer.hpp"
 #include "InputManager.hpp"
 #include "Logger.hpp"
 #include "Matrix4x4.hpp"
 #include "Mesh.hpp"
+#include "MeshArena.hpp"
 #include "MeshComponent.hpp"
 #include "PhysicsComponent.hpp"
+#include "PhysicsWorld.hpp"
+#include "ProgramCache.hpp"
 #include "Quaternion.hpp"
 #include "ResourceManager.hpp"
-#include "Shader.hpp"
+#include "ShaderLibrary.hpp"
 #include "TransformComponent.hpp"
 #include "Vector3.hpp"
 
+namespace
+{
+// view matrix of a camera placed at the transform
+auto get_view_matrix(TransformComponent camera_transform) -> Matrix4x4f
+{
+    camera_transform.position *= -1.0f;
+    camera_transform.rotation = camera_transform.rotation.inverse();
+    return Matrix4x4f::from_transform(camera_transform);
+}
+} // namespace
+
 Doom::Doom() :
-    player_movement_speed{0.05f}, vao_{NULL} , vbo_{NULL}, cbo_{NULL}, ibo_{NULL}, shader_program_{NULL}, perspective_matrix_()
+    player_movement_speed{0.05f}, snapshots_{}, vao_{NULL},
+    mesh_registry_{k_position_format, resource_manager_.asset_directory / "meshes", runtime_dir_ / "cache" / "meshes"},
+    mesh_arena_{mesh_registry_}, upload_buffer_{}, program_cache_{runtime_dir_ / "cache" / "programs"},
+    shader_library_{program_cache_, resource_manager_.asset_directory / "shaders"}, scene_shader_{}, gpu_culler_{},
+    storage_alignment_{k_upload_alignment}, shader_program_{NULL}, perspective_matrix_(), projection_matrix_{},
+    view_location_{-1}, physics_world_{mesh_registry_}
 {
     player_id_ = entity_manager_.create_entity();
     camera_angles_ = {0.0f, 0.0f};
@@ -46,70 +73,43 @@ auto Doom::setup() -> void
 {
     //////////////////// OpenGL ////////////////////
 
+    // construct shaders first so they compile while everything else loads
+    const std::array scene_stages{
+        ShaderLibrary::Stage{.type = GL_VERTEX_SHADER, .file_name = "scene.vert"},
+        ShaderLibrary::Stage{.type = GL_FRAGMENT_SHADER, .file_name = "scene.frag"},
+    };
+    const std::array scene_defines{
+        ShaderLibrary::Define{.name = "INSTANCE_BINDING", .value = std::to_string(k_instance_buffer_binding)},
+    };
+    // the driver compiles it while the culler and the meshes are created, render draws nothing until it is linked
+    const auto scene_shader = shader_library_.load(scene_stages, scene_defines);
+    if (!scene_shader) [[unlikely]] {
+        fatal_error("Could not load scene shader.");
+        return;
+    }
+    scene_shader_ = *scene_shader;
+
     // create buffers
     glCreateVertexArrays(1, &vao_);
     glBindVertexArray(vao_);
 
-    glCreateBuffers(1, &vbo_);
-    glCreateBuffers(1, &cbo_);
-    glCreateBuffers(1, &ibo_);
-    glVertexArrayElementBuffer(vao_, ibo_);
-
-    // construct shaders
-    std::vector<GLuint> shader_list;
-
-    constexpr std::string_view vertex_shader_string = R"(
-#version 460 core
-
-#define PI 3.1415926538f
-#define MAX_INSTANCE_COUNT 100
-
-layout (location = 0) in vec4 vector_position;
-layout (location = 1) in vec4 color;
-uniform mat4 model_views[MAX_INSTANCE_COUNT];
-uniform mat4 projection;
-smooth out vec4 pass_color;
-
-void main()
-{
-    gl_Position = projection * model_views[gl_InstanceID + gl_BaseInstance] * vector_position;
-    pass_color = color;
-}
-    )";
-    std::optional<GLuint> vertex_shader = shader::create_shader(vertex_shader_string, GL_VERTEX_SHADER);
-    if (!vertex_shader) [[unlikely]] {
-        fatal_error("Error compiling vertex shader.");
-    } else [[likely]] {
-        shader_list.push_back(*vertex_shader);
+    // both grow if the scene needs more
+    constexpr size_t initial_upload_frame_size{1 << 16};
+    constexpr size_t initial_arena_vertex_capacity{1 << 16};
+    // in bytes
+    constexpr size_t initial_arena_index_capacity{1 << 18};
+    mesh_arena_.create(initial_arena_vertex_capacity, initial_arena_index_capacity);
+    if (!upload_buffer_.create(initial_upload_frame_size)) [[unlikely]] {
+        fatal_error("Could not create upload buffer.");
     }
-
-    constexpr std::string_view fragment_shader_string = R"(
-#version 460 core
-
-smooth in vec4 pass_color;
-out vec4 out_color;
-
-void main()
-{
-    out_color = pass_color;
-}
-    )";
-    std::optional<GLuint> fragment_shader = shader::create_shader(fragment_shader_string, GL_FRAGMENT_SHADER);
-    if (!fragment_shader) [[unlikely]] {
-        fatal_error("Error compiling fragment shader.");
-    } else [[likely]] {
-        shader_list.push_back(*fragment_shader);
+    // per frame data is bound straight from the upload buffer
+    GLint storage_buffer_alignment{0};
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_buffer_alignment);
+    storage_alignment_ = std::max(k_upload_alignment, static_cast<size_t>(storage_buffer_alignment));
+    if (!gpu_culler_.create(program_cache_)) [[unlikely]] {
+        fatal_error("Could not create culling shader.");
     }
 
-    std::optional<GLuint> shader_program = shader::create_shader_program(shader_list);
-    if (!shader_program) [[unlikely]] {
-        fatal_error("Error compiling shader program.");
-    }
-    else [[likely]] {
-        shader_program_ = *shader_program;
-    }
-    std::for_each(shader_list.begin(), shader_list.end(), glDeleteShader);
-
     // create perspective matrix
     perspective_matrix_.fill(0.0f);
     constexpr float near = 0.5f;
@@ -123,23 +123,22 @@ void main()
     perspective_matrix_[14] = (2 * near * far) / (near - far);
     perspective_matrix_[11] = -1.0f;
 
-    glProgramUniformMatrix4fv(shader_program_, glGetUniformLocation(shader_program_, "projection"), 1, GL_FALSE, perspective_matrix_.data());
+    // perspective_matrix_ is column major
+    projection_matrix_ = Matrix4x4f{perspective_matrix_}.transpose();
 
-    // bind buffers and specify format
-    constexpr uint32_t vertex_buffer_bind_index{0};
-    constexpr size_t position_vector_size{3 * sizeof(float)};
-    glVertexArrayVertexBuffer(vao_, vertex_buffer_bind_index, vbo_, 0, position_vector_size);
-    glVertexArrayAttribBinding(vao_, 0, vertex_buffer_bind_index);
-    glVertexArrayAttribFormat(vao_, 0, 3, GL_FLOAT, GL_FALSE, 0);
+    // specify format of the arena's interleaved vertices, the buffer is bound every frame since the arena can grow
+    const Mesh::VertexLayout vertex_layout = Mesh::get_vertex_layout(k_position_format);
+    glVertexArrayAttribBinding(vao_, 0, k_vertex_buffer_bind_index);
+    glVertexArrayAttribFormat(vao_, 0, 3, vertex_layout.position_type, GL_FALSE, 0);
 
-    constexpr uint32_t color_buffer_bind_index{1};
-    constexpr size_t color_vector_size{4 * sizeof(float)};
-    glVertexArrayVertexBuffer(vao_, color_buffer_bind_index, cbo_, 0, color_vector_size);
-    glVertexArrayAttribBinding(vao_, 1, color_buffer_bind_index);
-    glVertexArrayAttribFormat(vao_, 1, 4, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(vao_, 1, k_vertex_buffer_bind_index);
+    glVertexArrayAttribFormat(vao_, 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, vertex_layout.color_offset);
     //TODO: is this needed?
     glBindBuffer(GL_ARRAY_BUFFER, NULL);
 
+    // opaque geometry is drawn front to back so the depth test rejects most overdraw early
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
@@ -147,14 +146,23 @@ void main()
     component_manager_.register_component<TransformComponent>();
     component_manager_.register_component<MeshComponent>();
     component_manager_.register_component<PhysicsComponent>();
+    component_manager_.register_component<ColliderComponent>();
 
     systems_.push_back(std::bind(&Doom::process_physics, this));
-    systems_.push_back(std::bind(&Doom::process_renders, this));
+    systems_.push_back(std::bind(&Doom::process_snapshot, this));
 
     auto& transform_components = component_manager_.get_components<TransformComponent>();
     auto& mesh_components = component_manager_.get_components<MeshComponent>();
     auto& physics_components = component_manager_.get_components<PhysicsComponent>();
 
+    const auto cube_mesh = mesh_registry_.load("cube");
+    const auto pyramid_mesh = mesh_registry_.load("pyramid");
+    const auto sphere_mesh = mesh_registry_.load("sphere");
+    if (!cube_mesh || !pyramid_mesh || !sphere_mesh) [[unlikely]] {
+        fatal_error("Could not load meshes.");
+        return;
+    }
+
     const TransformComponent player_transform
     {
         .entity_id = player_id_,
@@ -200,58 +208,90 @@ void main()
         .rotation = Quaternionf::identity(),
         .scale = {1.0f, 1.0f, 1.0f},
     };
+    // far enough away to be drawn with a coarser level of detail
+    TransformComponent sphere_transform = {
+        .entity_id = entity_manager_.create_entity(),
+        .position = {0.0f, 1.0f, -30.0f},
+        .rotation = Quaternionf::identity(),
+        .scale = {1.0f, 1.0f, 1.0f},
+    };
+    // falls onto cube_transform1
+    TransformComponent falling_cube_transform = {
+        .entity_id = entity_manager_.create_entity(),
+        .position = {2.0f, 6.0f, 0.0f},
+        .rotation = Quaternionf::identity(),
+        .scale = {0.5f, 0.5f, 0.5f},
+    };
 
     transform_components.insert_component(origin_cube_transform);
     mesh_components.insert_component({
         .entity_id = origin_cube_transform.entity_id,
-        .mesh_name = "cube",
+        .mesh = *cube_mesh,
     });
     transform_components.insert_component(cube_transform1);
     mesh_components.insert_component({
         .entity_id = cube_transform1.entity_id,
-        .mesh_name = "cube",
-        });
+        .mesh = *cube_mesh,
+    });
     transform_components.insert_component(cube_transform2);
     mesh_components.insert_component({
         .entity_id = cube_transform2.entity_id,
-        .mesh_name = "cube",
+        .mesh = *cube_mesh,
     });
     transform_components.insert_component(pyramid_transform1);
     mesh_components.insert_component({
         .entity_id = pyramid_transform1.entity_id,
-        .mesh_name = "pyramid",
+        .mesh = *pyramid_mesh,
     });
     transform_components.insert_component(pyramid_transform2);
     mesh_components.insert_component({
         .entity_id = pyramid_transform2.entity_id,
-        .mesh_name = "pyramid",
+        .mesh = *pyramid_mesh,
+    });
+    transform_components.insert_component(sphere_transform);
+    mesh_components.insert_component({
+        .entity_id = sphere_transform.entity_id,
+        .mesh = *sphere_mesh,
     });
+    transform_components.insert_component(falling_cube_transform);
+    mesh_components.insert_component({
+        .entity_id = falling_cube_transform.entity_id,
+        .mesh = *cube_mesh,
+    });
+    physics_components.insert_component({
+        .entity_id = falling_cube_transform.entity_id,
+        .velocity = {},
+        .acceleration = {},
+        .is_affected_by_gravity = true,
+    });
+    // the render thread starts out drawing the scene as set up
+    process_snapshot();
 
     /*
     const int e1 = entity_manager_.create_entity();
     transform_components.insert_component({e1, {-50 - 128, 50, -20}, direction, scale});
     render_components.insert_component(
-        {e1, RenderComponent::RenderableType::quad, resource_manager_.get_texture("brick"), 128, 128});
+        {e1, RenderComponent::RenderableType::quad, *resource_manager_.get_texture("brick"), 128, 128});
 
     const int e2 = entity_manager_.create_entity();
     transform_components.insert_component({e2, {50, 50, -20}, direction, scale});
     render_components.insert_component(
-        {e2, RenderComponent::RenderableType::quad, resource_manager_.get_texture("brick1"), 128, 128});
+        {e2, RenderComponent::RenderableType::quad, *resource_manager_.get_texture("brick1"), 128, 128});
 
     const int e3 = entity_manager_.create_entity();
     transform_components.insert_component({e3, {-50 - 128, -50 - 128, -20}, direction, scale});
     render_components.insert_component(
-        {e3, RenderComponent::RenderableType::quad, resource_manager_.get_texture("brick2"), 128, 128});
+        {e3, RenderComponent::RenderableType::quad, *resource_manager_.get_texture("brick2"), 128, 128});
 
     const int e4 = entity_manager_.create_entity();
     transform_components.insert_component({e4, {50, -50 - 128, -20}, direction, scale});
     render_components.insert_component(
-        {e4, RenderComponent::RenderableType::quad, resource_manager_.get_texture("wood"), 128, 128});
+        {e4, RenderComponent::RenderableType::quad, *resource_manager_.get_texture("wood"), 128, 128});
 
     const int e5 = entity_manager_.create_entity();
     transform_components.insert_component({e5, {-64, -64, -20}, direction, scale});
     render_components.insert_component(
-        {e5, RenderComponent::RenderableType::quad, resource_manager_.get_texture("aqpanl03"), 128, 128});
+        {e5, RenderComponent::RenderableType::quad, *resource_manager_.get_texture("aqpanl03"), 128, 128});
     */
 }
 
@@ -297,7 +337,6 @@ auto Doom::handle_event_key(const SDL_KeyboardEvent& event) -> void
 
 auto Doom::process_physics() -> void
 {
-    auto& transform_vector = component_manager_.get_components<TransformComponent>();
     auto& physics_vector = component_manager_.get_components<PhysicsComponent>();
 
     // Add movement speed to player's velocity
@@ -305,96 +344,184 @@ auto Doom::process_physics() -> void
     const Vector3f player_movement_vector = input_manager_.get_player_movement_vector() * player_movement_speed * delta_time_;
     player_physics_component.velocity += player_movement_vector;
 
-    for (auto& physics_component : physics_vector) {
-        //TODO: use physics_vector.transform
-        auto& transform_component = *transform_vector.find_component(physics_component.entity_id);
-        const Vector3f delta_v = physics_component.acceleration * delta_time_;
-        transform_component.position += physics_component.velocity * delta_time_;
-        transform_component.position += delta_v * delta_time_ / 2;
-        physics_component.velocity += delta_v;
-        // TODO: handle collision
-        transform_component.position.y -= PhysicsComponent::k_gravity * physics_component.is_affected_by_gravity;
-    }
+    // the camera follows the player, bodies far from it are stepped less often
+    physics_world_.set_lod_center(
+        component_manager_.get_components<TransformComponent>().find_component(player_id_)->position);
+    physics_world_.step(component_manager_, delta_time_);
 
     // Remove movement speed from player's velocity
     player_physics_component.velocity -= player_movement_vector;
-    auto& player_pos = transform_vector.find_component(player_id_)->position;
 }
 
-auto Doom::process_renders() -> void
+auto Doom::process_snapshot() -> void
 {
     auto& transform_vector = component_manager_.get_components<TransformComponent>();
     auto& mesh_vector = component_manager_.get_components<MeshComponent>();
 
-
-    // mapping mesh names to vector of instances of meshes
-    // TODO: this can probably be cached somewhere and changed only if a transform/meshcomponent is changed
-    std::unordered_map<std::string_view, std::vector<TransformComponent>> mesh_index;
-    for (const auto& mesh : mesh_vector) {
-        //TODO: linear search in transform_vector for every meshcomponent
-        // there should be a better way then O(n*m)
-        mesh_index[mesh.mesh_name].push_back(*transform_vector.find_component(mesh.entity_id));
+    RenderSnapshot& snapshot = snapshots_.get_write_buffer();
+    snapshot.camera = *transform_vector.find_component(player_id_);
+    const Matrix4x4f view_matrix = get_view_matrix(snapshot.camera);
+    snapshot.instances.clear();
+    for (auto& mesh : mesh_vector) {
+        const TransformComponent& transform = *transform_vector.find_component(mesh.entity_id);
+
+        MeshHandle drawn_mesh = mesh.mesh;
+        const auto lods = mesh_registry_.get_lods(mesh.mesh);
+        if (!lods.empty()) {
+            // fraction of the screen height the bounding sphere covers, the camera looks down -z
+            const float depth = -(view_matrix * transform.position).z;
+            const float max_scale = std::max(
+                {std::fabs(transform.scale.x), std::fabs(transform.scale.y), std::fabs(transform.scale.z)});
+            const float radius = mesh_registry_.get_bounding_sphere(mesh.mesh).radius * max_scale;
+            const float screen_size
+                = depth > 0.0f ? radius * perspective_matrix_[5] / depth : std::numeric_limits<float>::max();
+            mesh.lod_level = static_cast<uint32_t>(Mesh::select_lod(lods, screen_size, mesh.lod_level));
+            drawn_mesh = mesh_registry_.get_lod(mesh.mesh, mesh.lod_level);
+        }
+        snapshot.instances.push_back({
+            .mesh = drawn_mesh,
+            .transform = transform,
+        });
     }
+    snapshots_.publish();
+}
 
-    const size_t vertex_count{std::accumulate(mesh_index.begin(), mesh_index.end(), static_cast<size_t>(0), [](size_t count, const auto& mesh_pair) {
-        return count + Mesh::get_mesh(mesh_pair.first)->vertices.size();
-        })};
-
-    // data to be uploaded to buffers
-    std::vector<float> vertices;
-    std::vector<uint16_t> indices;
-    std::vector<float> colors;
-    vertices.reserve(vertex_count);
-    // 4 floats for color for every 3 floats for position
-    colors.reserve((vertex_count / 3) * 4);
-
-    int instance_counter{0};
-    std::vector<Mesh::DrawElementsIndirectCommand> draw_commands;
-    for (const auto& mesh_pair : mesh_index) {
-        const Mesh mesh{*Mesh::get_mesh(mesh_pair.first)};
-        auto draw_cmd = Mesh::insert_mesh(vertices, colors, indices, mesh);
-        const uint32_t instance_count{static_cast<uint32_t>(mesh_pair.second.size())};
-        draw_cmd.baseInstance = instance_counter;
-        draw_cmd.instanceCount = instance_count;
-        draw_commands.push_back(draw_cmd);
-        instance_counter += instance_count;
+auto Doom::render() -> std::optional<std::string>
+{
+    // nothing is drawn until the scene program is compiled, edited shader files are rebuilt in the background
+    shader_library_.update();
+    const ProgramStatus scene_status = shader_library_.poll(scene_shader_);
+    if (scene_status == ProgramStatus::failed) [[unlikely]] {
+        return "Error compiling shader program.";
+    }
+    if (scene_status == ProgramStatus::compiling) [[unlikely]] {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return std::nullopt;
+    }
+    // uniforms are set again whenever a reload replaced the program
+    const GLuint scene_program = *shader_library_.get_program(scene_shader_);
+    if (scene_program != shader_program_) [[unlikely]] {
+        shader_program_ = scene_program;
+        glProgramUniformMatrix4fv(shader_program_, glGetUniformLocation(shader_program_, "projection"), 1, GL_FALSE,
+            perspective_matrix_.data());
+        view_location_ = glGetUniformLocation(shader_program_, "view");
     }
 
-    //TODO: glNamedBufferData reallocates GPU memory every time it is called.
-    // Allocating once in setup() with a MAX_VBO_SIZE and using glNamedBufferSubData/glMapNamedBuffer
-    // might be more performant.
-    glNamedBufferData(vbo_, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    glNamedBufferData(cbo_, colors.size() * sizeof(float), colors.data(), GL_STATIC_DRAW);
-    glNamedBufferData(ibo_, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
-
-    auto camera_transform = *transform_vector.find_component(player_id_);
-    camera_transform.position *= -1.0f;
-    camera_transform.rotation = camera_transform.rotation.inverse();
-    const Matrix4x4f view_matrix = Matrix4x4f::from_transform(camera_transform);
-
-    std::vector<float> model_view_matrices;
-    model_view_matrices.resize(instance_counter * 16);
-    auto mv_iterator{model_view_matrices.begin()};
-    for (const auto& mesh_pair : mesh_index) {
-        for (const auto& transform : mesh_pair.second) {
-            const Matrix4x4f view_model = view_matrix * Matrix4x4f::from_transform(transform);
-            std::copy(view_model.data.begin(), view_model.data.end(), mv_iterator);
-            std::advance(mv_iterator, 16);
+    snapshots_.update();
+    const RenderSnapshot& snapshot = snapshots_.get_read_buffer();
+    const Matrix4x4f view_matrix = get_view_matrix(snapshot.camera);
+
+    // queue every instance by shader, mesh level of detail and distance in front of the camera
+    render_queue_.clear();
+    for (size_t i = 0; i < snapshot.instances.size(); i++) {
+        const RenderSnapshot::Instance& instance = snapshot.instances[i];
+        // the camera looks down -z
+        const float depth = -(view_matrix * instance.transform.position).z;
+        const bool wide_indices = mesh_registry_.get_index_type(instance.mesh) == GL_UNSIGNED_INT;
+        render_queue_.push(
+            RenderQueue::make_key(RenderPass::opaque, scene_shader_.index, wide_indices, instance.mesh.index, depth),
+            static_cast<uint32_t>(i));
+    }
+    render_queue_.sort();
+    const auto render_items = render_queue_.get_items();
+
+    // Write straight into the mapped region of this frame, grow the ring
+    // first if it does not fit. There is at most a draw command per item.
+    // Draw commands and bounding spheres are read as storage buffers by the
+    // culling shader too.
+    const size_t draw_commands_size{render_items.size() * sizeof(Mesh::DrawElementsIndirectCommand)};
+    const size_t bounding_spheres_size{render_items.size() * sizeof(std::array<float, 4>)};
+    const size_t instances_size{render_items.size() * sizeof(GpuCuller::Instance)};
+    // each allocation can lose up to its alignment to padding
+    const size_t upload_size{draw_commands_size + bounding_spheres_size + instances_size + 3 * storage_alignment_};
+    if (upload_size > upload_buffer_.get_frame_size()) [[unlikely]] {
+        Logger::get_default()->info(std::format("Growing upload buffer to {} bytes per frame.", std::bit_ceil(upload_size)));
+        if (!upload_buffer_.create(std::bit_ceil(upload_size))) [[unlikely]] {
+            return "Could not grow upload buffer.";
         }
     }
+    upload_buffer_.begin_frame();
+    const auto draw_commands_allocation{*upload_buffer_.allocate(draw_commands_size, storage_alignment_)};
+    const auto bounding_spheres_allocation{*upload_buffer_.allocate(bounding_spheres_size, storage_alignment_)};
+    const auto instances_allocation{*upload_buffer_.allocate(instances_size, storage_alignment_)};
+    auto* draw_commands{static_cast<Mesh::DrawElementsIndirectCommand*>(draw_commands_allocation.data)};
+    auto* bounding_spheres{static_cast<std::array<float, 4>*>(bounding_spheres_allocation.data)};
+    auto* instances{static_cast<GpuCuller::Instance*>(instances_allocation.data)};
+
+    // Geometry is resident in the mesh arena, every frame only the draw
+    // commands with no instances yet and the instances to cull are written.
+    // Items sharing a program and mesh become one draw command that leaves
+    // room for all of them from its baseInstance on, the culling shader
+    // counts in the visible ones. Commands of a shader and index width are
+    // drawn together.
+    draw_batches_.clear();
+    uint32_t draw_command_count{0};
+    uint32_t instance_counter{0};
+    for (size_t i = 0; i < render_items.size(); i++) {
+        const RenderQueue::Item& item = render_items[i];
+        if (i == 0 || RenderQueue::get_batch(item.key) != RenderQueue::get_batch(render_items[i - 1].key)) {
+            const ShaderHandle shader{RenderQueue::get_shader(item.key)};
+            const GLenum index_type = RenderQueue::get_wide_indices(item.key) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+            if (draw_batches_.empty() || draw_batches_.back().shader != shader
+                || draw_batches_.back().index_type != index_type) {
+                draw_batches_.push_back({
+                    .shader = shader,
+                    .program = *shader_library_.get_program(shader),
+                    .index_type = index_type,
+                    .first_command = draw_command_count,
+                    .command_count = 0,
+                });
+            }
+            draw_batches_.back().command_count++;
+
+            const MeshHandle mesh{RenderQueue::get_mesh(item.key)};
+            const Mesh::BoundingSphere& bounding_sphere = mesh_registry_.get_bounding_sphere(mesh);
+            bounding_spheres[draw_command_count]
+                = {bounding_sphere.center.x, bounding_sphere.center.y, bounding_sphere.center.z, bounding_sphere.radius};
+            Mesh::DrawElementsIndirectCommand draw_command = mesh_arena_.get_draw_command(mesh);
+            draw_command.baseInstance = instance_counter;
+            draw_commands[draw_command_count++] = draw_command;
+        }
+        instances[instance_counter++] = {
+            .model = Matrix4x4f::from_transform(snapshot.instances[item.index].transform),
+            .draw_index = draw_command_count - 1,
+            .padding = {},
+        };
+    }
 
-    glProgramUniformMatrix4fv(shader_program_, glGetUniformLocation(shader_program_, "model_views"), model_view_matrices.size() / 16, GL_TRUE, model_view_matrices.data());
+    const Frustum frustum = Frustum::from_matrix(projection_matrix_ * view_matrix);
+    gpu_culler_.cull(frustum,
+        {upload_buffer_.get_buffer(), instances_allocation.offset, instance_counter * sizeof(GpuCuller::Instance)},
+        {upload_buffer_.get_buffer(), bounding_spheres_allocation.offset,
+            draw_command_count * sizeof(std::array<float, 4>)},
+        {upload_buffer_.get_buffer(), draw_commands_allocation.offset,
+            draw_command_count * sizeof(Mesh::DrawElementsIndirectCommand)});
+
+    glProgramUniformMatrix4fv(shader_program_, view_location_, 1, GL_TRUE, view_matrix.data.data());
+    // the arena replaces its buffers when it grows
+    glVertexArrayVertexBuffer(vao_, k_vertex_buffer_bind_index, mesh_arena_.get_vertex_buffer(), 0,
+        mesh_arena_.get_vertex_layout().stride);
+    glVertexArrayElementBuffer(vao_, mesh_arena_.get_index_buffer());
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, upload_buffer_.get_buffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_instance_buffer_binding, gpu_culler_.get_visible_instance_buffer());
 
-    //TODO: z testing
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(shader_program_);
     glEnableVertexArrayAttrib(vao_, 0);
     glEnableVertexArrayAttrib(vao_, 1);
-    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, draw_commands.data(), draw_commands.size(), 0); 
+    for (const DrawBatch& batch : draw_batches_) {
+        glUseProgram(batch.program);
+        const size_t commands_offset = draw_commands_allocation.offset
+            + batch.first_command * sizeof(Mesh::DrawElementsIndirectCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, batch.index_type,
+            reinterpret_cast<const void*>(commands_offset), batch.command_count, 0);
+    }
     glDisableVertexArrayAttrib(vao_, 0);
     glDisableVertexArrayAttrib(vao_, 1);
+    upload_buffer_.end_frame();
 
     glUseProgram(NULL);
+    return std::nullopt;
 }
@@ -1,14 +1,31 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <GL/glew.h>
 #include <SDL_events.h>
 #include <SDL_render.h>
 
 #include "Game.hpp"
+#include "GpuCuller.hpp"
+#include "GpuRingBuffer.hpp"
 #include "Logger.hpp"
+#include "Matrix4x4.hpp"
 #include "Mesh.hpp"
+#include "MeshArena.hpp"
+#include "MeshRegistry.hpp"
+#include "PhysicsWorld.hpp"
+#include "ProgramCache.hpp"
+#include "RenderQueue.hpp"
+#include "RenderSnapshot.hpp"
+#include "ShaderLibrary.hpp"
+#include "TransformComponent.hpp"
+#include "TripleBuffer.hpp"
 
 class Doom : public Game {
 public:
@@ -23,21 +40,60 @@ private:
         double y;
     } camera_angles_;
     double player_movement_speed;
+    // frames simulated on the main thread for the render thread to draw
+    TripleBuffer<RenderSnapshot> snapshots_;
+    // latest build of scene_shader_ its uniforms were set for, 0 until the first is ready
     GLuint shader_program_;
     GLuint vao_;
-    GLuint vbo_;
-    GLuint cbo_;
-    GLuint ibo_;
+    // every mesh of the scene, components refer to them by handle
+    MeshRegistry mesh_registry_;
+    // geometry of every mesh drawn so far, uploaded once
+    MeshArena mesh_arena_;
+    // draw commands and instances to cull written every frame
+    GpuRingBuffer upload_buffer_;
+    // linked programs of earlier launches, loaded instead of compiling
+    ProgramCache program_cache_;
+    // shader files of the asset directory, reloaded when they change
+    ShaderLibrary shader_library_;
+    ShaderHandle scene_shader_;
+    GpuCuller gpu_culler_;
+    // alignment of data in the upload buffer bound as a storage buffer, at least what the driver needs
+    size_t storage_alignment_;
     std::array<float, 16> perspective_matrix_;
+    // row major copy of perspective_matrix_ to extract the view frustum from
+    Matrix4x4f projection_matrix_;
+    GLint view_location_;
+    // items index into the instances of the snapshot drawn
+    RenderQueue render_queue_;
+    // consecutive draw commands drawn with the same shader and index type
+    struct DrawBatch {
+        ShaderHandle shader;
+        GLuint program;
+        GLenum index_type;
+        uint32_t first_command;
+        uint32_t command_count;
+    };
+    std::vector<DrawBatch> draw_batches_;
+    PhysicsWorld physics_world_;
+
+    static constexpr uint32_t k_vertex_buffer_bind_index{0};
+    static constexpr Mesh::PositionFormat k_position_format{Mesh::PositionFormat::float16};
+    // storage buffer binding of the visible instances in the vertex shader
+    static constexpr uint32_t k_instance_buffer_binding{0};
+    // alignment of every allocation from the upload buffer, covers all the data types uploaded
+    static constexpr size_t k_upload_alignment{16};
 
     auto setup() -> void override;
     auto handle_event_window(const SDL_WindowEvent& event) -> void override;
     auto handle_event_mouse_motion(const SDL_MouseMotionEvent& event) -> void override;
     auto handle_event_key(const SDL_KeyboardEvent& event) -> void override;
+    // draws the latest snapshot, the registry is only read and the GL state is only touched here after setup
+    auto render() -> std::optional<std::string> override;
 
     // systems
     // cppcheck-suppress unusedPrivateFunction
     auto process_physics() -> void;
+    // publishes the meshes and the camera for the render thread, picks levels of detail on the way
     // cppcheck-suppress unusedPrivateFunction
-    auto process_renders() -> void;
+    auto process_snapshot() -> void;
 };
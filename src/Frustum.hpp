@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+#include "Aabb.hpp"
+#include "Matrix4x4.hpp"
+#include "Vector3.hpp"
+
+// points p with normal.dot(p) + distance >= 0 are on the inner side of the plane
+struct Plane {
+    Vector3f normal;
+    float distance;
+
+    auto signed_distance(const Vector3f& point) const -> float
+    {
+        return normal.dot(point) + distance;
+    }
+};
+
+// view volume described by six inward facing planes
+struct Frustum {
+    enum PlaneIndex { left = 0, right, bottom, top, near, far };
+
+    std::array<Plane, 6> planes;
+
+    // Extracts the planes of the clip volume of a row major view projection
+    // matrix. Planes are expressed in the space the matrix transforms from, so
+    // passing projection * view gives world space planes.
+    auto static from_matrix(const Matrix4x4f& matrix) -> Frustum
+    {
+        const auto row = [&matrix](int index) -> std::array<float, 4> {
+            return {matrix.at(index, 0), matrix.at(index, 1), matrix.at(index, 2), matrix.at(index, 3)};
+        };
+        const std::array<float, 4> w = row(3);
+        Frustum frustum{};
+        for (int axis = 0; axis < 3; axis++) {
+            const std::array<float, 4> r = row(axis);
+            frustum.planes[axis * 2] = make_plane(w[0] + r[0], w[1] + r[1], w[2] + r[2], w[3] + r[3]);
+            frustum.planes[axis * 2 + 1] = make_plane(w[0] - r[0], w[1] - r[1], w[2] - r[2], w[3] - r[3]);
+        }
+        return frustum;
+    }
+
+    // conservative, may report boxes near the corners of the frustum as intersecting
+    auto intersects(const Aabb& bounds) const -> bool
+    {
+        const Vector3f center = bounds.center();
+        const Vector3f half_extents = bounds.half_extents();
+        for (const Plane& plane : planes) {
+            const float radius = std::fabs(plane.normal.x) * half_extents.x + std::fabs(plane.normal.y) * half_extents.y
+                + std::fabs(plane.normal.z) * half_extents.z;
+            if (plane.signed_distance(center) < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto intersects_sphere(const Vector3f& center, float radius) const -> bool
+    {
+        for (const Plane& plane : planes) {
+            if (plane.signed_distance(center) < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    auto static make_plane(float a, float b, float c, float d) -> Plane
+    {
+        const float length = std::sqrt(a * a + b * b + c * c);
+        if (length == 0) [[unlikely]] {
+            return {{a, b, c}, d};
+        }
+        return {{a / length, b / length, c / length}, d / length};
+    }
+};
@@ -3,6 +3,8 @@
 #include <format>
 #include <optional>
 #include <string>
+#include <thread>
+#include <utility>
 
 #include <GL/glew.h>
 #include <SDL.h>
@@ -44,7 +46,7 @@ std::optional<std::wstring> get_executable_path() {
 Game::Game() :
     k_window_width{800.0}, k_window_height{600.0}, exiting_{false}, context_{nullptr}, entity_manager_{},
     component_manager_{}, input_manager_{}, systems_{}, delta_time_{0},
-    window_{NULL}, prev_time_{SDL_GetPerformanceCounter()}, shader_program_{0}
+    window_{NULL}, prev_time_{SDL_GetPerformanceCounter()}, drawn_frame_count_{0}, render_error_{}, shader_program_{0}
 {
     auto executable_path = get_executable_path();
     if(!executable_path) {
@@ -63,6 +65,8 @@ Game::Game() :
         fatal_error(std::string("Could not init SDL: ").append(SDL_GetError()));
     }
 
+    // the renderer depth tests
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     window_ = SDL_CreateWindow(
         "not-doom", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, k_window_width, k_window_height, SDL_WINDOW_OPENGL);
     if (window_ == NULL) {
@@ -105,12 +109,12 @@ Game::Game() :
     if (SDL_SetRelativeMouseMode(SDL_TRUE)) {
         logger->warning(std::string("Could not set relative mouse mode: ").append(SDL_GetError()));
     }
-
-    resource_manager_.set_context(context_);
 }
 
 Game::~Game()
 {
+    // textures go while the context still has its window
+    resource_manager_.destroy();
     SDL_DestroyWindow(window_);
     SDL_Quit();
 }
@@ -128,9 +132,26 @@ auto Game::fatal_error(const std::string& error_msg) -> void
 auto Game::start() -> void
 {
     setup();
-    while (!exiting_) {
-        loop();
-        SDL_GL_SwapWindow(window_);
+    if (exiting_) {
+        return;
+    }
+    // Simulating the next frame overlaps with drawing the last one. The
+    // context moves to the render thread and comes back once it stopped, so
+    // GL objects can be deleted here.
+    SDL_GL_MakeCurrent(window_, nullptr);
+    {
+        const std::jthread render_thread{[this](std::stop_token stop_token) { render_loop(stop_token); }};
+        uint64_t drawn_frame_count = drawn_frame_count_.load();
+        while (!exiting_) {
+            loop();
+            // the next frame is simulated while the render thread draws this one, never further ahead
+            drawn_frame_count_.wait(drawn_frame_count);
+            drawn_frame_count = drawn_frame_count_.load();
+        }
+    }
+    SDL_GL_MakeCurrent(window_, context_);
+    if (!render_error_.empty()) [[unlikely]] {
+        fatal_error(render_error_);
     }
 }
 
@@ -139,6 +160,29 @@ auto Game::get_current_time() const -> float
     return static_cast<float>(current_time_) / static_cast<float>(SDL_GetPerformanceFrequency());
 }
 
+auto Game::render_loop(std::stop_token stop_token) -> void
+{
+    if (SDL_GL_MakeCurrent(window_, context_) != 0) [[unlikely]] {
+        render_error_ = std::string("Could not make OpenGL context current on render thread: ").append(SDL_GetError());
+    }
+    while (render_error_.empty() && !stop_token.stop_requested()) {
+        if (auto error = render()) [[unlikely]] {
+            render_error_ = std::move(*error);
+            break;
+        }
+        SDL_GL_SwapWindow(window_);
+        drawn_frame_count_.fetch_add(1);
+        drawn_frame_count_.notify_one();
+    }
+    SDL_GL_MakeCurrent(window_, nullptr);
+    if (!render_error_.empty()) [[unlikely]] {
+        // wakes the main thread up to stop
+        exiting_ = true;
+        drawn_frame_count_.fetch_add(1);
+        drawn_frame_count_.notify_one();
+    }
+}
+
 auto Game::loop() -> void
 {
     current_time_ = SDL_GetPerformanceCounter();
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <optional>
 #include <stdint.h>
+#include <stop_token>
+#include <string>
 #include <vector>
 
 #include <GL/glew.h>
@@ -19,13 +23,15 @@ class Game {
 public:
     Game();
     ~Game();
+    // main thread only, the render thread returns its errors from render
     auto fatal_error(const std::string& error_msg) -> void;
+    // runs the systems on the calling thread and draws on a render thread until exiting
     auto start() -> void;
     const double k_window_width;
     const double k_window_height;
 
 protected:
-    bool exiting_;
+    std::atomic<bool> exiting_;
     SDL_GLContext context_;
     EntityManager entity_manager_;
     ComponentManager component_manager_;
@@ -54,7 +60,15 @@ private:
     SDL_Window* window_;
     uint64_t current_time_;
     uint64_t prev_time_;
+    // counted up by the render thread after every frame, the main thread simulates a frame per drawn frame
+    std::atomic<uint64_t> drawn_frame_count_;
+    // set by the render thread before it stops, shown once it is joined
+    std::string render_error_;
 
+    // runs with the context current on the calling thread, before the render thread takes it over
     virtual auto setup() -> void = 0;
+    // draws the latest simulated frame on the render thread, which owns the context, returns the error to exit with
+    virtual auto render() -> std::optional<std::string> = 0;
     auto loop() -> void;
+    auto render_loop(std::stop_token stop_token) -> void;
 };
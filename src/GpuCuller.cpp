@@ -0,0 +1,159 @@
+#include "GpuCuller.hpp"
+
+#include <bit>
+#include <optional>
+#include <string_view>
+
+#include "Logger.hpp"
+
+namespace
+{
+constexpr std::string_view k_cull_shader_string = R"(
+#version 450 core
+
+layout (local_size_x = 64) in;
+
+struct Instance {
+    mat4 model;
+    uint draw_index;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+};
+
+layout (std430, binding = 0, row_major) readonly buffer Instances
+{
+    Instance instances[];
+};
+layout (std430, binding = 1) readonly buffer BoundingSpheres
+{
+    vec4 bounding_spheres[];
+};
+layout (std430, binding = 2) buffer DrawCommands
+{
+    DrawCommand draw_commands[];
+};
+layout (std430, binding = 3, row_major) writeonly buffer VisibleInstances
+{
+    mat4 visible_models[];
+};
+
+uniform uint instance_count;
+// inward facing, normal in xyz and distance in w
+uniform vec4 frustum_planes[6];
+
+void main()
+{
+    const uint index = gl_GlobalInvocationID.x;
+    if (index >= instance_count) {
+        return;
+    }
+    const Instance instance = instances[index];
+    const vec4 sphere = bounding_spheres[instance.draw_index];
+    const vec3 center = (instance.model * vec4(sphere.xyz, 1.0f)).xyz;
+    // columns of the upper 3x3 are the scaled axes
+    const float scale = max(max(length(instance.model[0].xyz), length(instance.model[1].xyz)),
+        length(instance.model[2].xyz));
+    const float radius = sphere.w * scale;
+    for (int plane = 0; plane < 6; plane++) {
+        if (dot(frustum_planes[plane].xyz, center) + frustum_planes[plane].w < -radius) {
+            return;
+        }
+    }
+    const uint slot = atomicAdd(draw_commands[instance.draw_index].instance_count, 1u);
+    visible_models[draw_commands[instance.draw_index].base_instance + slot] = instance.model;
+}
+)";
+} // namespace
+
+GpuCuller::GpuCuller() :
+    program_{0}, instance_count_location_{-1}, frustum_planes_location_{-1}, visible_instance_buffer_{0},
+    visible_instance_capacity_{0}
+{
+}
+
+GpuCuller::~GpuCuller()
+{
+    destroy();
+}
+
+auto GpuCuller::create(ProgramCache& program_cache) -> bool
+{
+    destroy();
+
+    const ProgramCache::ShaderSource shader_source{.type = GL_COMPUTE_SHADER, .source = k_cull_shader_string};
+    const std::optional<GLuint> program = program_cache.wait_program(program_cache.submit_program({&shader_source, 1}));
+    if (!program) [[unlikely]] {
+        Logger::get_default()->error("Could not create culling shader program.");
+        return false;
+    }
+    program_ = *program;
+    instance_count_location_ = glGetUniformLocation(program_, "instance_count");
+    frustum_planes_location_ = glGetUniformLocation(program_, "frustum_planes");
+    return true;
+}
+
+auto GpuCuller::destroy() -> void
+{
+    // the program belongs to the program cache
+    program_ = 0;
+    if (visible_instance_buffer_ != 0) {
+        glDeleteBuffers(1, &visible_instance_buffer_);
+        visible_instance_buffer_ = 0;
+        visible_instance_capacity_ = 0;
+    }
+}
+
+auto GpuCuller::cull(const Frustum& frustum, const BufferRange& instances, const BufferRange& bounding_spheres,
+    const BufferRange& draw_commands) -> void
+{
+    const size_t instance_count = instances.size / sizeof(Instance);
+    if (instance_count == 0) [[unlikely]] {
+        return;
+    }
+    // only written by the gpu, commands reading the old buffer keep it alive until they are done
+    if (instance_count > visible_instance_capacity_) [[unlikely]] {
+        if (visible_instance_buffer_ != 0) {
+            glDeleteBuffers(1, &visible_instance_buffer_);
+        }
+        visible_instance_capacity_ = std::bit_ceil(instance_count);
+        glCreateBuffers(1, &visible_instance_buffer_);
+        glNamedBufferStorage(visible_instance_buffer_,
+            static_cast<GLsizeiptr>(visible_instance_capacity_ * sizeof(Matrix4x4f)), nullptr, 0);
+    }
+
+    std::array<float, 4 * 6> planes;
+    for (size_t i = 0; i < frustum.planes.size(); i++) {
+        const Plane& plane = frustum.planes[i];
+        planes[i * 4] = plane.normal.x;
+        planes[i * 4 + 1] = plane.normal.y;
+        planes[i * 4 + 2] = plane.normal.z;
+        planes[i * 4 + 3] = plane.distance;
+    }
+    glProgramUniform1ui(program_, instance_count_location_, static_cast<GLuint>(instance_count));
+    glProgramUniform4fv(program_, frustum_planes_location_, 6, planes.data());
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, k_instance_binding, instances.buffer, instances.offset,
+        static_cast<GLsizeiptr>(instances.size));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, k_bounding_sphere_binding, bounding_spheres.buffer,
+        bounding_spheres.offset, static_cast<GLsizeiptr>(bounding_spheres.size));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, k_draw_command_binding, draw_commands.buffer, draw_commands.offset,
+        static_cast<GLsizeiptr>(draw_commands.size));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, k_visible_instance_binding, visible_instance_buffer_);
+
+    glUseProgram(program_);
+    glDispatchCompute(static_cast<GLuint>((instance_count + k_group_size - 1) / k_group_size), 1, 1);
+    glUseProgram(0);
+    // draw commands are read as indirect commands and the visible instances from storage buffers
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+auto GpuCuller::get_visible_instance_buffer() const -> GLuint
+{
+    return visible_instance_buffer_;
+}
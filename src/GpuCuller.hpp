@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include "Frustum.hpp"
+#include "Matrix4x4.hpp"
+#include "ProgramCache.hpp"
+
+// Frustum culls instances in a compute shader. Visible instances are
+// compacted into a buffer owned by the culler and counted into the
+// instanceCount of their draw command on the GPU, so the draw commands can be
+// consumed by glMultiDrawElementsIndirect without reading anything back.
+class GpuCuller {
+public:
+    // std430 layout of an instance to cull
+    struct Instance {
+        // row major world matrix
+        Matrix4x4f model;
+        // index of the draw command and bounding sphere of the instance's mesh
+        uint32_t draw_index;
+        std::array<uint32_t, 3> padding;
+    };
+    static_assert(sizeof(Instance) == 80);
+
+    // bytes [offset, offset + size) of buffer
+    struct BufferRange {
+        GLuint buffer;
+        GLintptr offset;
+        size_t size;
+    };
+
+    GpuCuller();
+    ~GpuCuller();
+
+    GpuCuller(const GpuCuller&) = delete;
+    auto operator=(const GpuCuller&) -> GpuCuller& = delete;
+
+    // Creates the compute shader through program_cache and waits for it, the
+    // culler must be destroyed before the cache. Needs a current context.
+    auto create(ProgramCache& program_cache) -> bool;
+    auto destroy() -> void;
+
+    // Culls instances against the world space frustum. bounding_spheres holds
+    // a model space sphere (center, radius) per draw command. The draw
+    // commands must have an instanceCount of 0 and a baseInstance leaving
+    // room for all of their instances, visible ones are written to the
+    // visible instance buffer at baseInstance onwards in no particular order.
+    // Synchronizes the results with later draws and storage buffer reads.
+    auto cull(const Frustum& frustum, const BufferRange& instances, const BufferRange& bounding_spheres,
+        const BufferRange& draw_commands) -> void;
+
+    // row major world matrices of the visible instances, replaced when it grows
+    auto get_visible_instance_buffer() const -> GLuint;
+
+private:
+    static constexpr GLuint k_instance_binding = 0;
+    static constexpr GLuint k_bounding_sphere_binding = 1;
+    static constexpr GLuint k_draw_command_binding = 2;
+    static constexpr GLuint k_visible_instance_binding = 3;
+    // local size of the compute shader
+    static constexpr uint32_t k_group_size = 64;
+
+    GLuint program_;
+    GLint instance_count_location_;
+    GLint frustum_planes_location_;
+    GLuint visible_instance_buffer_;
+    // instances that fit in visible_instance_buffer_
+    size_t visible_instance_capacity_;
+};
@@ -0,0 +1,116 @@
+#include "GpuRingBuffer.hpp"
+
+#include <format>
+
+#include "Logger.hpp"
+
+namespace
+{
+constexpr GLbitfield k_map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+// nanoseconds to wait for a fence before checking it again
+constexpr GLuint64 k_fence_timeout = 1'000'000;
+} // namespace
+
+GpuRingBuffer::GpuRingBuffer() :
+    buffer_{0}, mapped_data_{nullptr}, frame_size_{0}, frame_{0}, head_{0}, fences_{}
+{
+}
+
+GpuRingBuffer::~GpuRingBuffer()
+{
+    destroy();
+}
+
+auto GpuRingBuffer::create(size_t frame_size) -> bool
+{
+    destroy();
+
+    glCreateBuffers(1, &buffer_);
+    const auto buffer_size = static_cast<GLsizeiptr>(frame_size * k_frame_count);
+    glNamedBufferStorage(buffer_, buffer_size, nullptr, k_map_flags);
+    mapped_data_ = static_cast<std::byte*>(glMapNamedBufferRange(buffer_, 0, buffer_size, k_map_flags));
+    if (mapped_data_ == nullptr) [[unlikely]] {
+        Logger::get_default()->error(std::format("Could not map ring buffer of {} bytes.", buffer_size));
+        glDeleteBuffers(1, &buffer_);
+        buffer_ = 0;
+        return false;
+    }
+    frame_size_ = frame_size;
+    frame_ = 0;
+    head_ = 0;
+    return true;
+}
+
+auto GpuRingBuffer::destroy() -> void
+{
+    if (buffer_ == 0) {
+        return;
+    }
+    for (size_t frame = 0; frame < k_frame_count; frame++) {
+        wait_for_fence(frame);
+    }
+    glUnmapNamedBuffer(buffer_);
+    glDeleteBuffers(1, &buffer_);
+    buffer_ = 0;
+    mapped_data_ = nullptr;
+    frame_size_ = 0;
+}
+
+auto GpuRingBuffer::begin_frame() -> void
+{
+    frame_ = (frame_ + 1) % k_frame_count;
+    head_ = 0;
+    wait_for_fence(frame_);
+}
+
+auto GpuRingBuffer::allocate(size_t size, size_t alignment) -> std::optional<Allocation>
+{
+    const size_t offset = (head_ + alignment - 1) / alignment * alignment;
+    if (offset + size > frame_size_) [[unlikely]] {
+        return std::nullopt;
+    }
+    head_ = offset + size;
+    const size_t buffer_offset = frame_ * frame_size_ + offset;
+    return Allocation{
+        .data = mapped_data_ + buffer_offset,
+        .offset = static_cast<GLintptr>(buffer_offset),
+    };
+}
+
+auto GpuRingBuffer::end_frame() -> void
+{
+    fences_[frame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+auto GpuRingBuffer::get_buffer() const -> GLuint
+{
+    return buffer_;
+}
+
+auto GpuRingBuffer::get_frame_size() const -> size_t
+{
+    return frame_size_;
+}
+
+auto GpuRingBuffer::wait_for_fence(size_t frame) -> void
+{
+    GLsync& fence = fences_[frame];
+    if (fence == nullptr) {
+        return;
+    }
+    // the first wait flushes so the fence is guaranteed to signal eventually
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        const GLenum result = glClientWaitSync(fence, flags, k_fence_timeout);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) [[likely]] {
+            break;
+        }
+        if (result == GL_WAIT_FAILED) [[unlikely]] {
+            Logger::get_default()->error("Waiting for ring buffer fence failed.");
+            break;
+        }
+        flags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
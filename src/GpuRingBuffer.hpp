@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include <GL/glew.h>
+
+// Immutable buffer mapped once for the lifetime of the ring and split into
+// one region per frame in flight. The CPU writes a frame's data straight
+// into the mapped region while the GPU reads the regions of earlier frames,
+// fences keep a region from being reused before the GPU is done with it.
+class GpuRingBuffer {
+public:
+    static constexpr size_t k_frame_count = 3;
+
+    struct Allocation {
+        // mapped memory to write to
+        void* data;
+        // offset from the start of the buffer to bind or draw with
+        GLintptr offset;
+    };
+
+    GpuRingBuffer();
+    ~GpuRingBuffer();
+
+    GpuRingBuffer(const GpuRingBuffer&) = delete;
+    auto operator=(const GpuRingBuffer&) -> GpuRingBuffer& = delete;
+
+    // Creates the buffer with frame_size bytes per frame, replacing the
+    // current one after the GPU is done with it. Needs a current context
+    // with buffer storage support.
+    auto create(size_t frame_size) -> bool;
+    auto destroy() -> void;
+
+    // waits until the GPU is done with the region of the new frame and starts allocating from it
+    auto begin_frame() -> void;
+    // nothing if the region of the frame is full
+    auto allocate(size_t size, size_t alignment) -> std::optional<Allocation>;
+    // fences the commands reading the frame's region, call after the last draw using it
+    auto end_frame() -> void;
+
+    auto get_buffer() const -> GLuint;
+    auto get_frame_size() const -> size_t;
+
+private:
+    GLuint buffer_;
+    std::byte* mapped_data_;
+    size_t frame_size_;
+    size_t frame_;
+    // offset into the region of the current frame
+    size_t head_;
+    std::array<GLsync, k_frame_count> fences_;
+
+    auto wait_for_fence(size_t frame) -> void;
+};
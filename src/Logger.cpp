@@ -2,6 +2,7 @@
 // IWYU pragma: no_include <bits/chrono.h> // for operator-, floor, milliseconds, system_clock
 #include <format>
 #include <iostream>
+#include <mutex>
 #include <ostream>
 
 #include "Logger.hpp"
@@ -48,7 +49,8 @@ auto Logger::get_default() -> Logger*
     return default_logger_.get();
 }
 
-Logger::Logger(std::ostream* output_stream, LogLevel log_level) noexcept : output_stream_(output_stream), log_level_{log_level}
+Logger::Logger(std::ostream* output_stream, LogLevel log_level) noexcept :
+    output_stream_(output_stream), log_level_{log_level}, mutex_{}
 {
 }
 
@@ -64,6 +66,7 @@ auto Logger::write(const std::string& string) const -> void
     if (output_stream_ == nullptr) {
         return;
     }
+    const std::scoped_lock lock{mutex_};
     *output_stream_ << string << '\n';
 }
 
@@ -96,6 +99,7 @@ auto Logger::error(const std::string& string) const -> void
     if (log_level_ >= LogLevel::error) {
         write(std::format("{0:%F %T} [ERROR]: {1}",
             std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now()), string));
+        const std::scoped_lock lock{mutex_};
         output_stream_->flush();
     }
 }
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <string>
 
 class Logger {
@@ -29,4 +30,6 @@ private:
     static std::filesystem::path base_dir_;
     std::unique_ptr<std::ostream> output_stream_;
     LogLevel log_level_;
+    // the main and the render thread log at the same time
+    mutable std::mutex mutex_;
 };
@@ -1,11 +1,25 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <span>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 
 #include <GL/glew.h>
 
+#include "Aabb.hpp"
 #include "Logger.hpp"
+#include "Vector3.hpp"
 
 #define COLOR_RED 1.0f, 0.0f, 0.0f, 1.0f
 #define COLOR_GREEN 0.0f, 1.0f, 0.0f, 1.0f
@@ -24,46 +38,156 @@ public:
         uint32_t baseInstance;
     } DrawElementsIndirectCommand;
 
+    struct BoundingSphere {
+        Vector3f center;
+        float radius;
+    };
+
+    // Half floats keep about three significant digits, enough for positions
+    // in model space and half the size of full floats.
+    enum class PositionFormat {
+        float32,
+        float16,
+    };
+
+    // Vertices are interleaved into a single buffer, a position of three
+    // components followed by a normalized RGBA8 color.
+    struct VertexLayout {
+        // GL_FLOAT or GL_HALF_FLOAT
+        GLenum position_type;
+        GLuint color_offset;
+        GLsizei stride;
+    };
+
+    // coarser version of a mesh, drawn while the mesh covers less than max_screen_size of the screen height
+    struct Lod {
+        std::string_view mesh_name;
+        float max_screen_size;
+    };
+    // fraction a screen size has to cross a lod threshold by before the level changes
+    static constexpr float k_lod_hysteresis = 0.1f;
+
     std::vector<float> vertices;
     std::vector<float> colors;
-    std::vector<uint16_t> indices;
+    std::vector<uint32_t> indices;
+    // from finest to coarsest, empty if the mesh has a single level
+    std::vector<Lod> lods;
+
+    // bounds of the mesh in model space
+    auto local_bounds() const -> Aabb
+    {
+        if (vertices.empty()) [[unlikely]] {
+            return {};
+        }
+        constexpr float float_max = std::numeric_limits<float>::max();
+        Aabb bounds{{float_max, float_max, float_max}, {-float_max, -float_max, -float_max}};
+        for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+            bounds = bounds.merged({{vertices[i], vertices[i + 1], vertices[i + 2]}, {vertices[i], vertices[i + 1], vertices[i + 2]}});
+        }
+        return bounds;
+    }
 
-    auto static insert_mesh(std::vector<float>& buffer, std::vector<float>& color_buffer, std::vector<uint16_t>& indices, const Mesh& mesh) -> DrawElementsIndirectCommand
+    // sphere around the center of local_bounds, in model space
+    auto local_bounding_sphere() const -> BoundingSphere
     {
-        const int32_t vertices_start = buffer.size() / 3; //3 floats per vertex
-        buffer.insert(buffer.end(), mesh.vertices.begin(), mesh.vertices.end());
-        color_buffer.insert(color_buffer.end(), mesh.colors.begin(), mesh.colors.end());
-        const uint32_t indices_start = indices.size();
-        indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
-        return {
-            .count = static_cast<uint32_t>(mesh.indices.size()),
-            .instanceCount = 0,
-            .firstIndex = indices_start,
-            .baseVertex = vertices_start,
-            .baseInstance = 0,
-        };
+        const Vector3f center = local_bounds().center();
+        float radius_squared{0.0f};
+        for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+            const Vector3f offset = Vector3f{vertices[i], vertices[i + 1], vertices[i + 2]} - center;
+            radius_squared = std::max(radius_squared, offset.dot(offset));
+        }
+        return {center, std::sqrt(radius_squared)};
     }
 
-    auto static get_mesh(std::string_view mesh_name) -> std::optional<Mesh>
+    auto static get_vertex_layout(PositionFormat position_format) -> VertexLayout
     {
-        auto mesh_it = mesh_index_.find(mesh_name);
-        if (mesh_it == mesh_index_.end()) [[unlikely]] {
-            const auto mesh = load_mesh(mesh_name);
-            if (mesh == false) [[unlikely]] {
-                return std::nullopt;
+        switch (position_format) {
+            case PositionFormat::float16: {
+                // three halves padded to four bytes
+                return {.position_type = GL_HALF_FLOAT, .color_offset = 8, .stride = 12};
+            }
+            case PositionFormat::float32:
+            default: {
+                return {.position_type = GL_FLOAT, .color_offset = 12, .stride = 16};
             }
-            mesh_it = mesh_index_.find(mesh_name);
         }
-        return mesh_it->second;
     }
 
-private:
-    inline static std::unordered_map<std::string_view, Mesh> mesh_index_;
+    // 16 bit if they can address every vertex, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    auto get_index_type() const -> GLenum
+    {
+        return vertices.size() / 3 <= k_max_short_index_vertex_count ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    auto static get_index_size(GLenum index_type) -> size_t
+    {
+        return index_type == GL_UNSIGNED_INT ? sizeof(uint32_t) : sizeof(uint16_t);
+    }
+
+    // indices in the width of get_index_type, ready to upload
+    auto pack_indices() const -> std::vector<std::byte>
+    {
+        if (get_index_type() == GL_UNSIGNED_INT) {
+            const auto bytes = std::as_bytes(std::span{indices});
+            return {bytes.begin(), bytes.end()};
+        }
+        std::vector<std::byte> packed(indices.size() * sizeof(uint16_t));
+        for (size_t i = 0; i < indices.size(); i++) {
+            const auto index = static_cast<uint16_t>(indices[i]);
+            std::memcpy(packed.data() + i * sizeof(index), &index, sizeof(index));
+        }
+        return packed;
+    }
+
+    // vertices interleaved in the layout of position_format, ready to upload
+    auto pack_vertices(PositionFormat position_format) const -> std::vector<std::byte>
+    {
+        const VertexLayout layout = get_vertex_layout(position_format);
+        const size_t vertex_count = vertices.size() / 3;
+        std::vector<std::byte> packed(vertex_count * layout.stride);
+        for (size_t i = 0; i < vertex_count; i++) {
+            std::byte* vertex = packed.data() + i * layout.stride;
+            const float* position = vertices.data() + i * 3;
+            if (position_format == PositionFormat::float16) {
+                const std::array<uint16_t, 3> half_position{to_half(position[0]), to_half(position[1]), to_half(position[2])};
+                std::memcpy(vertex, half_position.data(), sizeof(half_position));
+            }
+            else {
+                std::memcpy(vertex, position, 3 * sizeof(float));
+            }
+            // meshes without colors are drawn white
+            std::array<uint8_t, 4> color{255, 255, 255, 255};
+            if ((i + 1) * 4 <= colors.size()) [[likely]] {
+                for (size_t channel = 0; channel < 4; channel++) {
+                    color[channel] = to_unorm8(colors[i * 4 + channel]);
+                }
+            }
+            std::memcpy(vertex + layout.color_offset, color.data(), sizeof(color));
+        }
+        return packed;
+    }
+
+    // Level of detail to draw a mesh with, 0 for the mesh itself and i + 1
+    // for lods[i]. Levels only change once screen_size is past a threshold by
+    // k_lod_hysteresis so instances near one do not flicker between levels.
+    auto static select_lod(std::span<const Lod> lods, float screen_size, size_t current_level) -> size_t
+    {
+        size_t level = std::min(current_level, lods.size());
+        while (level < lods.size() && screen_size < lods[level].max_screen_size * (1.0f - k_lod_hysteresis)) {
+            level++;
+        }
+        while (level > 0 && screen_size > lods[level - 1].max_screen_size * (1.0f + k_lod_hysteresis)) {
+            level--;
+        }
+        return level;
+    }
 
-    auto static load_mesh(std::string_view mesh_name) -> bool
+    // Builds the named mesh, nothing if there is no mesh with that name.
+    // Every call builds it again, load meshes through a MeshRegistry instead.
+    auto static load(std::string_view mesh_name) -> std::optional<Mesh>
     {
         if (mesh_name == "cube") {
-            mesh_index_[mesh_name] = {
+            return Mesh{
                 .vertices{ 
                     //front
                     -0.5f,  0.5f,  0.5f,
@@ -124,10 +248,11 @@ private:
                     // bottom
                     20, 21, 22, 23, 22, 21
                 },
+                .lods{},
             };
         }
         else if (mesh_name == "pyramid") {
-            mesh_index_[mesh_name] = {
+            return Mesh{
                 .vertices{ 
                     // base
                     -1.0f, -1.0f,  1.0f,
@@ -171,12 +296,80 @@ private:
                     10, 11, 12,
                     14, 13, 15,
                 },
+                .lods{},
             };
         }
-        else {
-            Logger::get_default()->warning(std::format("Mesh named {} could not be loaded.", mesh_name));
-            return false;
+        else if (mesh_name == "sphere") {
+            Mesh sphere = make_sphere(32, 64);
+            sphere.lods = {
+                {.mesh_name = "sphere_lod1", .max_screen_size = 0.25f},
+                {.mesh_name = "sphere_lod2", .max_screen_size = 0.08f},
+            };
+            return sphere;
+        }
+        else if (mesh_name == "sphere_lod1") {
+            return make_sphere(16, 32);
+        }
+        else if (mesh_name == "sphere_lod2") {
+            return make_sphere(8, 16);
+        }
+        Logger::get_default()->warning(std::format("Mesh named {} could not be loaded.", mesh_name));
+        return std::nullopt;
+    }
+
+private:
+    static constexpr size_t k_max_short_index_vertex_count = size_t{std::numeric_limits<uint16_t>::max()} + 1;
+
+    // Rounds to the nearest half float. Values too small for a normal half are
+    // flushed to zero and values too large become infinity.
+    auto static to_half(float value) -> uint16_t
+    {
+        const auto bits = std::bit_cast<uint32_t>(value);
+        const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+        const uint32_t mantissa = bits & 0x7fffff;
+        if (exponent <= 0) {
+            return sign;
+        }
+        if (exponent >= 31) {
+            return sign | 0x7c00;
+        }
+        // a carry out of the mantissa correctly moves to the next exponent
+        const uint32_t half = (static_cast<uint32_t>(exponent) << 10 | mantissa >> 13) + ((mantissa >> 12) & 1);
+        return static_cast<uint16_t>(sign | std::min(half, 0x7c00u));
+    }
+
+    auto static to_unorm8(float value) -> uint8_t
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    // unit sphere with rings bands of latitude, colored band by band
+    auto static make_sphere(int rings, int segments) -> Mesh
+    {
+        constexpr float band_colors[][4]{{COLOR_RED}, {COLOR_YELLOW}};
+        Mesh sphere;
+        for (int ring = 0; ring <= rings; ring++) {
+            const float theta = std::numbers::pi_v<float> * static_cast<float>(ring) / static_cast<float>(rings);
+            for (int segment = 0; segment <= segments; segment++) {
+                const float phi
+                    = 2.0f * std::numbers::pi_v<float> * static_cast<float>(segment) / static_cast<float>(segments);
+                sphere.vertices.insert(sphere.vertices.end(),
+                    {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)});
+                const auto& color = band_colors[ring % 2];
+                sphere.colors.insert(sphere.colors.end(), color, color + 4);
+            }
+        }
+        // two counter clockwise triangles per quad between consecutive rings and segments
+        for (int ring = 0; ring < rings; ring++) {
+            for (int segment = 0; segment < segments; segment++) {
+                const auto a = static_cast<uint32_t>(ring * (segments + 1) + segment);
+                const auto b = static_cast<uint32_t>(a + segments + 1);
+                const auto c = a + 1;
+                const auto d = b + 1;
+                sphere.indices.insert(sphere.indices.end(), {a, c, b, c, d, b});
+            }
         }
-        return true;
+        return sphere;
     }
 };
@@ -0,0 +1,136 @@
+#include "MeshArena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+
+#include "Logger.hpp"
+
+namespace
+{
+// buffer with fixed size that is only written through glNamedBufferSubData
+auto create_buffer(size_t size) -> GLuint
+{
+    GLuint buffer;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    return buffer;
+}
+
+// creates a bigger buffer holding the first used_size bytes of buffer and deletes buffer
+auto grow_buffer(GLuint buffer, size_t used_size, size_t new_size) -> GLuint
+{
+    const GLuint new_buffer = create_buffer(new_size);
+    if (used_size > 0) {
+        glCopyNamedBufferSubData(buffer, new_buffer, 0, 0, static_cast<GLsizeiptr>(used_size));
+    }
+    glDeleteBuffers(1, &buffer);
+    return new_buffer;
+}
+} // namespace
+
+MeshArena::MeshArena(const MeshRegistry& mesh_registry) :
+    mesh_registry_{mesh_registry}, vertex_buffer_{0}, index_buffer_{0},
+    vertex_layout_{Mesh::get_vertex_layout(mesh_registry.get_position_format())}, vertex_capacity_{0}, index_capacity_{0},
+    vertex_count_{0}, index_size_{0}, draw_commands_{}
+{
+}
+
+MeshArena::~MeshArena()
+{
+    destroy();
+}
+
+auto MeshArena::create(size_t vertex_capacity, size_t index_capacity) -> void
+{
+    destroy();
+    vertex_buffer_ = create_buffer(vertex_capacity * vertex_layout_.stride);
+    index_buffer_ = create_buffer(index_capacity);
+    vertex_capacity_ = vertex_capacity;
+    index_capacity_ = index_capacity;
+}
+
+auto MeshArena::destroy() -> void
+{
+    if (vertex_buffer_ == 0) {
+        return;
+    }
+    const GLuint buffers[]{vertex_buffer_, index_buffer_};
+    glDeleteBuffers(2, buffers);
+    vertex_buffer_ = 0;
+    index_buffer_ = 0;
+    vertex_capacity_ = 0;
+    index_capacity_ = 0;
+    vertex_count_ = 0;
+    index_size_ = 0;
+    draw_commands_.clear();
+}
+
+auto MeshArena::get_draw_command(MeshHandle mesh) -> const Mesh::DrawElementsIndirectCommand&
+{
+    if (mesh.index >= draw_commands_.size()) [[unlikely]] {
+        draw_commands_.resize(mesh_registry_.size());
+    }
+    auto& draw_command = draw_commands_[mesh.index];
+    if (!draw_command) [[unlikely]] {
+        draw_command = upload(
+            mesh_registry_.get_vertices(mesh), mesh_registry_.get_indices(mesh), mesh_registry_.get_index_type(mesh));
+    }
+    return *draw_command;
+}
+
+auto MeshArena::get_vertex_buffer() const -> GLuint
+{
+    return vertex_buffer_;
+}
+
+auto MeshArena::get_index_buffer() const -> GLuint
+{
+    return index_buffer_;
+}
+
+auto MeshArena::get_vertex_layout() const -> const Mesh::VertexLayout&
+{
+    return vertex_layout_;
+}
+
+auto MeshArena::upload(std::span<const std::byte> vertices, std::span<const std::byte> indices, GLenum index_type)
+    -> Mesh::DrawElementsIndirectCommand
+{
+    const size_t mesh_vertex_count = vertices.size() / vertex_layout_.stride;
+    // firstIndex counts in indices of the draw's type, so 32 bit indices start 4 byte aligned
+    const size_t index_size = Mesh::get_index_size(index_type);
+    const size_t index_offset = (index_size_ + index_size - 1) / index_size * index_size;
+    if (vertex_count_ + mesh_vertex_count > vertex_capacity_ || index_offset + indices.size() > index_capacity_)
+        [[unlikely]] {
+        grow(std::max(vertex_capacity_ * 2, vertex_count_ + mesh_vertex_count),
+            std::max(index_capacity_ * 2, index_offset + indices.size()));
+    }
+
+    glNamedBufferSubData(vertex_buffer_, vertex_count_ * vertex_layout_.stride, vertices.size(), vertices.data());
+    glNamedBufferSubData(index_buffer_, index_offset, indices.size(), indices.data());
+
+    // indices stay relative to the mesh, base vertex moves them to the mesh's vertices
+    const Mesh::DrawElementsIndirectCommand draw_command{
+        .count = static_cast<uint32_t>(indices.size() / index_size),
+        .instanceCount = 0,
+        .firstIndex = static_cast<uint32_t>(index_offset / index_size),
+        .baseVertex = static_cast<int32_t>(vertex_count_),
+        .baseInstance = 0,
+    };
+    vertex_count_ += mesh_vertex_count;
+    index_size_ = index_offset + indices.size();
+    return draw_command;
+}
+
+auto MeshArena::grow(size_t vertex_capacity, size_t index_capacity) -> void
+{
+    Logger::get_default()->info(
+        std::format("Growing mesh arena to {} vertices and {} bytes of indices.", vertex_capacity, index_capacity));
+    vertex_buffer_
+        = grow_buffer(vertex_buffer_, vertex_count_ * vertex_layout_.stride, vertex_capacity * vertex_layout_.stride);
+    index_buffer_ = grow_buffer(index_buffer_, index_size_, index_capacity);
+    vertex_capacity_ = vertex_capacity;
+    index_capacity_ = index_capacity;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "Mesh.hpp"
+#include "MeshRegistry.hpp"
+
+// Vertex and index buffers shared by every mesh of a registry. A mesh is
+// uploaded once when it is first drawn and stays resident, drawing it
+// afterwards only needs its cached draw command.
+class MeshArena {
+public:
+    explicit MeshArena(const MeshRegistry& mesh_registry);
+    ~MeshArena();
+
+    MeshArena(const MeshArena&) = delete;
+    auto operator=(const MeshArena&) -> MeshArena& = delete;
+
+    // Creates buffers with room for vertex_capacity vertices and
+    // index_capacity bytes of indices, they grow when a mesh does not fit
+    // anymore. Vertices are in the registry's layout. Needs a current context.
+    auto create(size_t vertex_capacity, size_t index_capacity) -> void;
+    auto destroy() -> void;
+
+    // Draw command of the mesh with no instances, uploads the mesh on first
+    // use. Its indices are of the registry's index type for the mesh, meshes
+    // of both widths share the index buffer.
+    auto get_draw_command(MeshHandle mesh) -> const Mesh::DrawElementsIndirectCommand&;
+
+    // buffers can be replaced when the arena grows, bind them again after registering meshes
+    auto get_vertex_buffer() const -> GLuint;
+    auto get_index_buffer() const -> GLuint;
+    auto get_vertex_layout() const -> const Mesh::VertexLayout&;
+
+private:
+    const MeshRegistry& mesh_registry_;
+    GLuint vertex_buffer_;
+    GLuint index_buffer_;
+    Mesh::VertexLayout vertex_layout_;
+    size_t vertex_capacity_;
+    // in bytes, 16 and 32 bit indices are mixed
+    size_t index_capacity_;
+    size_t vertex_count_;
+    size_t index_size_;
+    // indexed by mesh handle, empty until the mesh is uploaded
+    std::vector<std::optional<Mesh::DrawElementsIndirectCommand>> draw_commands_;
+
+    // copies already packed vertices and their indices of index_type to the end of the buffers
+    auto upload(std::span<const std::byte> vertices, std::span<const std::byte> indices, GLenum index_type)
+        -> Mesh::DrawElementsIndirectCommand;
+    // reallocates the buffers with at least the given capacities and copies the meshes over on the gpu
+    auto grow(size_t vertex_capacity, size_t index_capacity) -> void;
+};
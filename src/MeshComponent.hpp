@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
+
+#include "MeshRegistry.hpp"
 #include "TransformComponent.hpp"
 
 struct MeshComponent {
     int entity_id;
-    std::string_view mesh_name;
+    MeshHandle mesh;
+    // level of detail picked last frame, see Mesh::select_lod
+    uint32_t lod_level = 0;
 };
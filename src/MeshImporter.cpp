@@ -0,0 +1,700 @@
+#include "MeshImporter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Logger.hpp"
+
+namespace
+{
+// indices are 32 bit, Mesh narrows them to 16 bit when they fit
+constexpr size_t k_max_vertex_count = size_t{std::numeric_limits<uint32_t>::max()} + 1;
+
+auto import_error(std::string_view format_name, std::string_view reason) -> std::nullopt_t
+{
+    Logger::get_default()->warning(std::format("Could not import {} mesh: {}.", format_name, reason));
+    return std::nullopt;
+}
+
+// splits off the next word separated by spaces or tabs, empty at the end of the line
+auto next_token(std::string_view& line) -> std::string_view
+{
+    const size_t begin = std::min(line.find_first_not_of(" \t"), line.size());
+    const size_t end = std::min(line.find_first_of(" \t", begin), line.size());
+    const std::string_view token = line.substr(begin, end - begin);
+    line.remove_prefix(end);
+    return token;
+}
+
+template <typename T>
+auto to_number(std::string_view text) -> std::optional<T>
+{
+    T value;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Parsed JSON document. Objects keep their keys in order and are searched
+// linearly, glTF objects only have a handful of keys.
+struct Json {
+    enum class Type {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object,
+    };
+
+    Type type = Type::null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    // elements of an array or values of an object
+    std::vector<Json> elements;
+    // keys of an object, keys[i] names elements[i]
+    std::vector<std::string> keys;
+
+    // value of the key, nullptr if this is not an object or has no such key
+    auto find(std::string_view key) const -> const Json*
+    {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == key) {
+                return &elements[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // nullptr if this is not an array or the index is out of range
+    auto at(size_t index) const -> const Json*
+    {
+        return type == Type::array && index < elements.size() ? &elements[index] : nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) :
+        text_{text}, position_{0}
+    {
+    }
+
+    // nothing if the text is not a single valid JSON value
+    auto parse() -> std::optional<Json>
+    {
+        Json value;
+        if (!parse_value(value, 0)) {
+            return std::nullopt;
+        }
+        skip_whitespace();
+        if (position_ != text_.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+private:
+    // deeper documents are rejected instead of overflowing the stack
+    static constexpr int k_max_depth = 64;
+
+    std::string_view text_;
+    size_t position_;
+
+    auto skip_whitespace() -> void
+    {
+        while (position_ < text_.size()
+            && (text_[position_] == ' ' || text_[position_] == '\t' || text_[position_] == '\n'
+                || text_[position_] == '\r')) {
+            position_++;
+        }
+    }
+
+    // skips whitespace and the character if it is next
+    auto consume(char character) -> bool
+    {
+        skip_whitespace();
+        if (position_ < text_.size() && text_[position_] == character) {
+            position_++;
+            return true;
+        }
+        return false;
+    }
+
+    auto consume_literal(std::string_view literal) -> bool
+    {
+        if (!text_.substr(position_).starts_with(literal)) {
+            return false;
+        }
+        position_ += literal.size();
+        return true;
+    }
+
+    auto parse_value(Json& value, int depth) -> bool
+    {
+        skip_whitespace();
+        if (position_ >= text_.size() || depth > k_max_depth) {
+            return false;
+        }
+        switch (text_[position_]) {
+            case '{': {
+                return parse_object(value, depth);
+            }
+            case '[': {
+                return parse_array(value, depth);
+            }
+            case '"': {
+                value.type = Json::Type::string;
+                return parse_string(value.string);
+            }
+            case 't': {
+                value.type = Json::Type::boolean;
+                value.boolean = true;
+                return consume_literal("true");
+            }
+            case 'f': {
+                value.type = Json::Type::boolean;
+                value.boolean = false;
+                return consume_literal("false");
+            }
+            case 'n': {
+                value.type = Json::Type::null;
+                return consume_literal("null");
+            }
+            default: {
+                value.type = Json::Type::number;
+                return parse_number(value.number);
+            }
+        }
+    }
+
+    auto parse_object(Json& value, int depth) -> bool
+    {
+        value.type = Json::Type::object;
+        position_++;
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            skip_whitespace();
+            std::string key;
+            if (position_ >= text_.size() || text_[position_] != '"' || !parse_string(key) || !consume(':')) {
+                return false;
+            }
+            value.keys.push_back(std::move(key));
+            if (!parse_value(value.elements.emplace_back(), depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    auto parse_array(Json& value, int depth) -> bool
+    {
+        value.type = Json::Type::array;
+        position_++;
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (!parse_value(value.elements.emplace_back(), depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    auto parse_string(std::string& string) -> bool
+    {
+        position_++;
+        while (position_ < text_.size()) {
+            const char character = text_[position_++];
+            if (character == '"') {
+                return true;
+            }
+            if (character != '\\') {
+                string.push_back(character);
+                continue;
+            }
+            if (position_ >= text_.size()) {
+                return false;
+            }
+            switch (const char escaped = text_[position_++]) {
+                case '"':
+                case '\\':
+                case '/': {
+                    string.push_back(escaped);
+                    break;
+                }
+                case 'b': {
+                    string.push_back('\b');
+                    break;
+                }
+                case 'f': {
+                    string.push_back('\f');
+                    break;
+                }
+                case 'n': {
+                    string.push_back('\n');
+                    break;
+                }
+                case 'r': {
+                    string.push_back('\r');
+                    break;
+                }
+                case 't': {
+                    string.push_back('\t');
+                    break;
+                }
+                case 'u': {
+                    auto code_point = parse_code_unit();
+                    // a high surrogate followed by a low one encodes a code point past the basic plane
+                    if (code_point && *code_point >= 0xd800 && *code_point < 0xdc00 && consume_literal("\\u")) {
+                        const auto low_surrogate = parse_code_unit();
+                        if (!low_surrogate || *low_surrogate < 0xdc00 || *low_surrogate >= 0xe000) {
+                            return false;
+                        }
+                        code_point = 0x10000 + ((*code_point - 0xd800) << 10) + (*low_surrogate - 0xdc00);
+                    }
+                    if (!code_point) {
+                        return false;
+                    }
+                    append_utf8(string, *code_point);
+                    break;
+                }
+                default: {
+                    return false;
+                }
+            }
+        }
+        return false;
+    }
+
+    // four hex digits of a \u escape
+    auto parse_code_unit() -> std::optional<uint32_t>
+    {
+        if (position_ + 4 > text_.size()) {
+            return std::nullopt;
+        }
+        uint32_t code_unit;
+        const char* begin = text_.data() + position_;
+        const auto [end, error] = std::from_chars(begin, begin + 4, code_unit, 16);
+        if (error != std::errc{} || end != begin + 4) {
+            return std::nullopt;
+        }
+        position_ += 4;
+        return code_unit;
+    }
+
+    auto parse_number(double& number) -> bool
+    {
+        const size_t end = std::min(text_.find_first_not_of("+-0123456789.eE", position_), text_.size());
+        const auto parsed = to_number<double>(text_.substr(position_, end - position_));
+        if (!parsed) {
+            return false;
+        }
+        number = *parsed;
+        position_ = end;
+        return true;
+    }
+
+    auto static append_utf8(std::string& string, uint32_t code_point) -> void
+    {
+        if (code_point < 0x80) {
+            string.push_back(static_cast<char>(code_point));
+        }
+        else if (code_point < 0x800) {
+            string.push_back(static_cast<char>(0xc0 | code_point >> 6));
+            string.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        }
+        else if (code_point < 0x10000) {
+            string.push_back(static_cast<char>(0xe0 | code_point >> 12));
+            string.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3f)));
+            string.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        }
+        else {
+            string.push_back(static_cast<char>(0xf0 | code_point >> 18));
+            string.push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3f)));
+            string.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3f)));
+            string.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        }
+    }
+};
+
+// "glTF", "JSON" and "BIN\0" read as little endian integers
+constexpr uint32_t k_glb_magic = 0x46546c67;
+constexpr uint32_t k_glb_json_chunk = 0x4e4f534a;
+constexpr uint32_t k_glb_binary_chunk = 0x004e4942;
+constexpr size_t k_glb_header_size = 12;
+constexpr size_t k_glb_chunk_header_size = 8;
+constexpr size_t k_gltf_triangles_mode = 4;
+
+auto read_u32(std::span<const std::byte> data, size_t offset) -> uint32_t
+{
+    uint32_t value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+// Non negative whole number that fits in 32 bits, nothing otherwise. Every
+// offset and count in glTF is one, the bound keeps the arithmetic on them
+// from overflowing.
+auto get_count(const Json* value) -> std::optional<size_t>
+{
+    if (value == nullptr || value->type != Json::Type::number || value->number < 0.0
+        || value->number > static_cast<double>(std::numeric_limits<uint32_t>::max())
+        || value->number != std::floor(value->number)) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(value->number);
+}
+
+template <typename T>
+auto read_value(const std::byte* source) -> double
+{
+    T value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<double>(value);
+}
+
+// normalized integers are mapped to [0, 1] or [-1, 1], other integers keep their value
+auto read_component(const std::byte* source, size_t component_type, bool is_normalized) -> double
+{
+    switch (component_type) {
+        case 5120: {
+            return is_normalized ? std::max(read_value<int8_t>(source) / 127.0, -1.0) : read_value<int8_t>(source);
+        }
+        case 5121: {
+            return is_normalized ? read_value<uint8_t>(source) / 255.0 : read_value<uint8_t>(source);
+        }
+        case 5122: {
+            return is_normalized ? std::max(read_value<int16_t>(source) / 32767.0, -1.0) : read_value<int16_t>(source);
+        }
+        case 5123: {
+            return is_normalized ? read_value<uint16_t>(source) / 65535.0 : read_value<uint16_t>(source);
+        }
+        case 5125: {
+            return is_normalized ? read_value<uint32_t>(source) / 4294967295.0 : read_value<uint32_t>(source);
+        }
+        default: {
+            return read_value<float>(source);
+        }
+    }
+}
+
+// elements of an accessor flattened, component_count values per element
+struct Accessor {
+    std::vector<double> values;
+    size_t component_count;
+    size_t component_type;
+    bool is_normalized;
+};
+
+// reads an accessor out of the binary chunk, see read_component
+auto read_accessor(const Json& document, std::span<const std::byte> binary, size_t accessor_index)
+    -> std::optional<Accessor>
+{
+    const Json* accessors = document.find("accessors");
+    const Json* accessor = accessors ? accessors->at(accessor_index) : nullptr;
+    if (accessor == nullptr) {
+        return import_error("glTF", std::format("accessor {} does not exist", accessor_index));
+    }
+    if (accessor->find("sparse") != nullptr) {
+        return import_error("glTF", "sparse accessors are not supported");
+    }
+    const auto count = get_count(accessor->find("count"));
+    const auto component_type = get_count(accessor->find("componentType"));
+    const Json* type = accessor->find("type");
+    const auto view_index = get_count(accessor->find("bufferView"));
+    const Json* buffer_views = document.find("bufferViews");
+    const Json* view = buffer_views && view_index ? buffer_views->at(*view_index) : nullptr;
+    if (!count || !component_type || type == nullptr || view == nullptr) {
+        return import_error("glTF", std::format("accessor {} is incomplete", accessor_index));
+    }
+    if (get_count(view->find("buffer")).value_or(1) != 0) {
+        return import_error("glTF", "only the buffer in the binary chunk can be read");
+    }
+
+    size_t component_count{0};
+    for (const auto& [type_name, type_components] :
+        {std::pair{"SCALAR", 1}, std::pair{"VEC2", 2}, std::pair{"VEC3", 3}, std::pair{"VEC4", 4}}) {
+        if (type->string == type_name) {
+            component_count = type_components;
+        }
+    }
+    size_t component_size{0};
+    switch (*component_type) {
+        case 5120:
+        case 5121: {
+            component_size = 1;
+            break;
+        }
+        case 5122:
+        case 5123: {
+            component_size = 2;
+            break;
+        }
+        case 5125:
+        case 5126: {
+            component_size = 4;
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+    if (component_count == 0 || component_size == 0) {
+        return import_error("glTF", std::format("accessor {} has an unsupported type", accessor_index));
+    }
+
+    const size_t element_size = component_size * component_count;
+    const size_t stride = get_count(view->find("byteStride")).value_or(element_size);
+    // elements may not overlap, otherwise a few bytes could claim any count
+    if (stride < element_size || stride % component_size != 0) {
+        return import_error("glTF", std::format("accessor {} has an invalid stride", accessor_index));
+    }
+    const size_t view_offset = get_count(view->find("byteOffset")).value_or(0);
+    const size_t view_length = get_count(view->find("byteLength")).value_or(0);
+    const size_t begin = view_offset + get_count(accessor->find("byteOffset")).value_or(0);
+    const size_t end = *count == 0 ? begin : begin + (*count - 1) * stride + element_size;
+    if (end > view_offset + view_length || end > binary.size()) {
+        return import_error("glTF", std::format("accessor {} is out of bounds", accessor_index));
+    }
+
+    const Json* normalized = accessor->find("normalized");
+    const bool is_normalized = normalized != nullptr && normalized->boolean;
+    Accessor result{
+        .values{},
+        .component_count = component_count,
+        .component_type = *component_type,
+        .is_normalized = is_normalized,
+    };
+    result.values.reserve(*count * component_count);
+    for (size_t element = 0; element < *count; element++) {
+        for (size_t component = 0; component < component_count; component++) {
+            const std::byte* source = binary.data() + begin + element * stride + component * component_size;
+            result.values.push_back(read_component(source, *component_type, is_normalized));
+        }
+    }
+    return result;
+}
+} // namespace
+
+namespace mesh_import
+{
+auto from_obj(std::string_view text) -> std::optional<Mesh>
+{
+    Mesh mesh;
+    // rgb of every vertex, only kept if any vertex has a color
+    std::vector<float> colors;
+    bool has_colors{false};
+    size_t line_number{0};
+    while (!text.empty()) {
+        const size_t line_end = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, line_end);
+        text.remove_prefix(std::min(line_end + 1, text.size()));
+        line_number++;
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+
+        const std::string_view keyword = next_token(line);
+        if (keyword == "v") {
+            std::vector<float> values;
+            for (std::string_view token = next_token(line); !token.empty(); token = next_token(line)) {
+                const auto value = to_number<float>(token);
+                if (!value) {
+                    return import_error("OBJ", std::format("invalid number on line {}", line_number));
+                }
+                values.push_back(*value);
+            }
+            if (values.size() < 3) {
+                return import_error("OBJ", std::format("vertex on line {} has less than 3 coordinates", line_number));
+            }
+            mesh.vertices.insert(mesh.vertices.end(), values.begin(), values.begin() + 3);
+            if (values.size() >= 6) {
+                colors.insert(colors.end(), values.begin() + 3, values.begin() + 6);
+                has_colors = true;
+            }
+            else {
+                colors.insert(colors.end(), {1.0f, 1.0f, 1.0f});
+            }
+        }
+        else if (keyword == "f") {
+            const auto vertex_count = static_cast<long long>(mesh.vertices.size() / 3);
+            std::vector<uint32_t> polygon;
+            for (std::string_view token = next_token(line); !token.empty(); token = next_token(line)) {
+                // only the position of "v/vt/vn" is used, negative indices count back from the last vertex
+                const auto index = to_number<long long>(token.substr(0, token.find('/')));
+                const long long vertex = index && *index < 0 ? vertex_count + *index : index.value_or(0) - 1;
+                if (!index || vertex < 0 || vertex >= vertex_count) {
+                    return import_error("OBJ", std::format("invalid vertex index on line {}", line_number));
+                }
+                polygon.push_back(static_cast<uint32_t>(vertex));
+            }
+            if (polygon.size() < 3) {
+                return import_error("OBJ", std::format("face on line {} has less than 3 vertices", line_number));
+            }
+            for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i], polygon[i + 1]});
+            }
+        }
+    }
+
+    if (mesh.indices.empty()) {
+        return import_error("OBJ", "no faces");
+    }
+    if (mesh.vertices.size() / 3 > k_max_vertex_count) {
+        return import_error("OBJ", std::format("more than {} vertices", k_max_vertex_count));
+    }
+    if (has_colors) {
+        for (size_t i = 0; i + 2 < colors.size(); i += 3) {
+            mesh.colors.insert(mesh.colors.end(), {colors[i], colors[i + 1], colors[i + 2], 1.0f});
+        }
+    }
+    return mesh;
+}
+
+auto from_glb(std::span<const std::byte> data) -> std::optional<Mesh>
+{
+    if (data.size() < k_glb_header_size + k_glb_chunk_header_size || read_u32(data, 0) != k_glb_magic
+        || read_u32(data, 4) != 2) {
+        return import_error("glTF", "not a binary glTF 2.0 file");
+    }
+    // the length of the whole file, trailing bytes past it are ignored
+    const size_t length = read_u32(data, 8);
+    if (length < k_glb_header_size + k_glb_chunk_header_size || length > data.size()) {
+        return import_error("glTF", "the header length does not match the file");
+    }
+    data = data.first(length);
+    const size_t json_size = read_u32(data, k_glb_header_size);
+    const size_t json_offset = k_glb_header_size + k_glb_chunk_header_size;
+    if (read_u32(data, k_glb_header_size + 4) != k_glb_json_chunk || json_offset + json_size > data.size()) {
+        return import_error("glTF", "the first chunk is not JSON");
+    }
+    // the binary chunk is optional, accessors into a missing one are out of bounds
+    std::span<const std::byte> binary;
+    const size_t binary_header_offset = json_offset + json_size;
+    if (binary_header_offset + k_glb_chunk_header_size <= data.size()
+        && read_u32(data, binary_header_offset + 4) == k_glb_binary_chunk) {
+        const size_t binary_offset = binary_header_offset + k_glb_chunk_header_size;
+        binary = data.subspan(binary_offset, std::min<size_t>(read_u32(data, binary_header_offset),
+            data.size() - binary_offset));
+    }
+
+    const auto document
+        = JsonParser{{reinterpret_cast<const char*>(data.data() + json_offset), json_size}}.parse();
+    if (!document) {
+        return import_error("glTF", "invalid JSON");
+    }
+    const Json* meshes = document->find("meshes");
+    const Json* first_mesh = meshes ? meshes->at(0) : nullptr;
+    const Json* primitives = first_mesh ? first_mesh->find("primitives") : nullptr;
+    if (primitives == nullptr || primitives->type != Json::Type::array) {
+        return import_error("glTF", "no meshes");
+    }
+
+    Mesh mesh;
+    for (const Json& primitive : primitives->elements) {
+        if (get_count(primitive.find("mode")).value_or(k_gltf_triangles_mode) != k_gltf_triangles_mode) {
+            continue;
+        }
+        const Json* attributes = primitive.find("attributes");
+        const auto position_accessor = get_count(attributes ? attributes->find("POSITION") : nullptr);
+        if (!position_accessor) {
+            return import_error("glTF", "a primitive has no positions");
+        }
+        const auto positions = read_accessor(*document, binary, *position_accessor);
+        if (!positions || positions->component_count != 3) {
+            return import_error("glTF", "positions have to be three component vectors");
+        }
+        const size_t base_vertex = mesh.vertices.size() / 3;
+        const size_t vertex_count = positions->values.size() / 3;
+        if (base_vertex + vertex_count > k_max_vertex_count) {
+            return import_error("glTF", std::format("more than {} vertices", k_max_vertex_count));
+        }
+        for (const double position : positions->values) {
+            mesh.vertices.push_back(static_cast<float>(position));
+        }
+
+        // primitives without colors are white
+        const auto color_accessor = get_count(attributes->find("COLOR_0"));
+        const auto colors = color_accessor ? read_accessor(*document, binary, *color_accessor) : std::nullopt;
+        if (color_accessor
+            && (!colors || colors->component_count < 3 || colors->values.size() / colors->component_count != vertex_count)) {
+            return import_error("glTF", "colors do not match the positions");
+        }
+        for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+            for (size_t channel = 0; channel < 4; channel++) {
+                const bool has_channel = colors && channel < colors->component_count;
+                mesh.colors.push_back(
+                    has_channel ? static_cast<float>(colors->values[vertex * colors->component_count + channel]) : 1.0f);
+            }
+        }
+
+        const auto index_accessor = get_count(primitive.find("indices"));
+        if (!index_accessor) {
+            for (size_t vertex = 0; vertex + 2 < vertex_count; vertex += 3) {
+                for (size_t corner = 0; corner < 3; corner++) {
+                    mesh.indices.push_back(static_cast<uint32_t>(base_vertex + vertex + corner));
+                }
+            }
+            continue;
+        }
+        const auto indices = read_accessor(*document, binary, *index_accessor);
+        if (!indices || indices->component_count != 1 || indices->values.size() % 3 != 0) {
+            return import_error("glTF", "indices do not form triangles");
+        }
+        // unsigned byte, short or int, other types can be negative or fractional
+        const bool is_index_type
+            = indices->component_type == 5121 || indices->component_type == 5123 || indices->component_type == 5125;
+        if (!is_index_type || indices->is_normalized) {
+            return import_error("glTF", "indices have to be unsigned integers");
+        }
+        for (const double index : indices->values) {
+            if (index >= static_cast<double>(vertex_count)) {
+                return import_error("glTF", "an index is out of bounds");
+            }
+            mesh.indices.push_back(static_cast<uint32_t>(base_vertex + static_cast<size_t>(index)));
+        }
+    }
+
+    if (mesh.indices.empty()) {
+        return import_error("glTF", "no triangles");
+    }
+    return mesh;
+}
+
+auto from_file(const std::filesystem::path& path) -> std::optional<Mesh>
+{
+    std::ifstream file{path, std::ios_base::binary};
+    if (!file) {
+        Logger::get_default()->warning(std::format("Could not open mesh file {}.", path.string()));
+        return std::nullopt;
+    }
+    const std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    const auto extension = path.extension();
+    if (extension == ".obj") {
+        return from_obj(contents);
+    }
+    if (extension == ".glb") {
+        return from_glb(std::as_bytes(std::span{contents}));
+    }
+    Logger::get_default()->warning(std::format("No importer for mesh file {}.", path.string()));
+    return std::nullopt;
+}
+} // namespace mesh_import
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "Mesh.hpp"
+
+// Builds meshes from authored files. Only positions, vertex colors and
+// triangles are imported, everything else in the files is skipped. Importing
+// is slow, meshes are meant to be imported once and baked, see BakedMesh.
+namespace mesh_import
+{
+// extensions of the files from_file imports, in the order they are looked for
+inline constexpr std::array<std::string_view, 2> k_extensions{".glb", ".obj"};
+
+// Wavefront OBJ, vertex colors are read from the common "v x y z r g b" extension.
+// Polygons are split into triangle fans.
+auto from_obj(std::string_view text) -> std::optional<Mesh>;
+// binary glTF 2.0, every triangle primitive of the first mesh without node transforms
+auto from_glb(std::span<const std::byte> data) -> std::optional<Mesh>;
+// picks the importer by the file's extension, nothing if the file can not be read or imported
+auto from_file(const std::filesystem::path& path) -> std::optional<Mesh>;
+} // namespace mesh_import
@@ -0,0 +1,265 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t k_no_vertex = std::numeric_limits<uint32_t>::max();
+constexpr size_t k_no_triangle = std::numeric_limits<size_t>::max();
+
+// weights from Forsyth's paper
+constexpr float k_cache_decay_power = 1.5f;
+constexpr float k_last_triangle_score = 0.75f;
+constexpr float k_valence_boost_scale = 2.0f;
+constexpr float k_valence_boost_power = 0.5f;
+
+// Vertices used by the last triangle score the same so its order does not
+// matter, older ones score less the further back they are. Vertices with
+// few triangles left are boosted to finish them off before they leave the
+// cache. -1 for vertices without triangles left.
+auto get_vertex_score(int cache_position, uint32_t remaining_triangles) -> float
+{
+    if (remaining_triangles == 0) {
+        return -1.0f;
+    }
+    float score{0.0f};
+    if (cache_position >= 0 && cache_position < 3) {
+        score = k_last_triangle_score;
+    }
+    else if (cache_position >= 3) {
+        const float age = static_cast<float>(cache_position - 3) / static_cast<float>(mesh_optimize::k_cache_size - 3);
+        score = std::pow(1.0f - age, k_cache_decay_power);
+    }
+    return score + k_valence_boost_scale * std::pow(static_cast<float>(remaining_triangles), -k_valence_boost_power);
+}
+
+// color of the vertex, white if the mesh has none for it like Mesh::pack_vertices
+auto get_color(const Mesh& mesh, size_t vertex) -> std::array<float, 4>
+{
+    if ((vertex + 1) * 4 > mesh.colors.size()) {
+        return {1.0f, 1.0f, 1.0f, 1.0f};
+    }
+    return {mesh.colors[vertex * 4], mesh.colors[vertex * 4 + 1], mesh.colors[vertex * 4 + 2],
+        mesh.colors[vertex * 4 + 3]};
+}
+
+// Keeps the vertices remap maps to, new_vertex_count of them, at their new
+// positions. Vertices mapped to k_no_vertex are dropped.
+auto remap_vertices(Mesh& mesh, std::span<const uint32_t> remap, size_t new_vertex_count) -> void
+{
+    std::vector<float> vertices(new_vertex_count * 3);
+    std::vector<float> colors(mesh.colors.empty() ? 0 : new_vertex_count * 4);
+    for (size_t vertex = 0; vertex < remap.size(); vertex++) {
+        if (remap[vertex] == k_no_vertex) {
+            continue;
+        }
+        std::copy_n(mesh.vertices.begin() + vertex * 3, 3, vertices.begin() + remap[vertex] * 3);
+        if (!colors.empty()) {
+            const auto color = get_color(mesh, vertex);
+            std::ranges::copy(color, colors.begin() + remap[vertex] * 4);
+        }
+    }
+    mesh.vertices = std::move(vertices);
+    mesh.colors = std::move(colors);
+}
+} // namespace
+
+namespace mesh_optimize
+{
+auto remove_duplicate_vertices(Mesh& mesh) -> void
+{
+    // exact bits of the position and color, so only identical vertices merge
+    using VertexKey = std::array<uint32_t, 7>;
+    struct VertexKeyHash {
+        auto operator()(const VertexKey& key) const -> size_t
+        {
+            // FNV-1a over the words
+            uint64_t hash = 14695981039346656037ull;
+            for (const uint32_t word : key) {
+                hash = (hash ^ word) * 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    const size_t vertex_count = mesh.vertices.size() / 3;
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique_vertices;
+    unique_vertices.reserve(vertex_count);
+    std::vector<uint32_t> remap(vertex_count);
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        const auto color = get_color(mesh, vertex);
+        const VertexKey key{
+            std::bit_cast<uint32_t>(mesh.vertices[vertex * 3]),
+            std::bit_cast<uint32_t>(mesh.vertices[vertex * 3 + 1]),
+            std::bit_cast<uint32_t>(mesh.vertices[vertex * 3 + 2]),
+            std::bit_cast<uint32_t>(color[0]),
+            std::bit_cast<uint32_t>(color[1]),
+            std::bit_cast<uint32_t>(color[2]),
+            std::bit_cast<uint32_t>(color[3]),
+        };
+        remap[vertex] = unique_vertices.try_emplace(key, static_cast<uint32_t>(unique_vertices.size())).first->second;
+    }
+    if (unique_vertices.size() == vertex_count) {
+        return;
+    }
+    for (uint32_t& index : mesh.indices) {
+        index = remap[index];
+    }
+    remap_vertices(mesh, remap, unique_vertices.size());
+}
+
+auto optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count) -> void
+{
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // triangles of every vertex, the first remaining_triangles[v] from triangle_offsets[v] on are not emitted yet
+    std::vector<uint32_t> triangle_offsets(vertex_count + 1, 0);
+    for (const uint32_t index : indices.first(triangle_count * 3)) {
+        triangle_offsets[index + 1]++;
+    }
+    std::vector<uint32_t> remaining_triangles(vertex_count);
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        remaining_triangles[vertex] = triangle_offsets[vertex + 1];
+        triangle_offsets[vertex + 1] += triangle_offsets[vertex];
+    }
+    std::vector<uint32_t> vertex_triangles(triangle_count * 3);
+    {
+        std::vector<uint32_t> fill_offsets(triangle_offsets.begin(), triangle_offsets.end() - 1);
+        for (size_t i = 0; i < triangle_count * 3; i++) {
+            vertex_triangles[fill_offsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        vertex_scores[vertex] = get_vertex_score(-1, remaining_triangles[vertex]);
+    }
+    const auto get_triangle_score = [&](size_t triangle) {
+        return vertex_scores[indices[triangle * 3]] + vertex_scores[indices[triangle * 3 + 1]]
+            + vertex_scores[indices[triangle * 3 + 2]];
+    };
+    size_t best_triangle{0};
+    for (size_t triangle = 1; triangle < triangle_count; triangle++) {
+        if (get_triangle_score(triangle) > get_triangle_score(best_triangle)) {
+            best_triangle = triangle;
+        }
+    }
+
+    std::vector<bool> is_emitted(triangle_count, false);
+    std::vector<uint32_t> optimized;
+    optimized.reserve(triangle_count * 3);
+    // cache from the most recent vertex on, room for a triangle past its end before the oldest are evicted
+    std::array<uint32_t, k_cache_size + 3> cache;
+    size_t cache_count{0};
+    // triangles before it are all emitted, used when no triangle touches the cache
+    size_t next_unemitted_triangle{0};
+
+    for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+        if (best_triangle == k_no_triangle) {
+            while (is_emitted[next_unemitted_triangle]) {
+                next_unemitted_triangle++;
+            }
+            best_triangle = next_unemitted_triangle;
+        }
+        const std::array<uint32_t, 3> triangle{
+            indices[best_triangle * 3], indices[best_triangle * 3 + 1], indices[best_triangle * 3 + 2]};
+        optimized.insert(optimized.end(), triangle.begin(), triangle.end());
+        is_emitted[best_triangle] = true;
+
+        // move the triangle to the end of its vertices' remaining triangles and drop it from them
+        for (const uint32_t vertex : triangle) {
+            const auto begin = vertex_triangles.begin() + triangle_offsets[vertex];
+            const auto end = begin + remaining_triangles[vertex];
+            std::iter_swap(std::find(begin, end, static_cast<uint32_t>(best_triangle)), end - 1);
+            remaining_triangles[vertex]--;
+        }
+
+        // the triangle's vertices move to the front, the rest keep their order behind them
+        std::array<uint32_t, k_cache_size + 3> new_cache;
+        size_t new_cache_count{0};
+        for (const uint32_t vertex : triangle) {
+            if (std::find(new_cache.begin(), new_cache.begin() + new_cache_count, vertex)
+                == new_cache.begin() + new_cache_count) {
+                new_cache[new_cache_count++] = vertex;
+            }
+        }
+        for (size_t i = 0; i < cache_count; i++) {
+            if (std::find(triangle.begin(), triangle.end(), cache[i]) == triangle.end()) {
+                new_cache[new_cache_count++] = cache[i];
+            }
+        }
+        for (size_t i = 0; i < new_cache_count; i++) {
+            const uint32_t vertex = new_cache[i];
+            cache_positions[vertex] = i < k_cache_size ? static_cast<int>(i) : -1;
+            vertex_scores[vertex] = get_vertex_score(cache_positions[vertex], remaining_triangles[vertex]);
+        }
+
+        // only triangles of vertices that moved in the cache changed score, the best of them is emitted next
+        best_triangle = k_no_triangle;
+        float best_score{-1.0f};
+        for (size_t i = 0; i < new_cache_count; i++) {
+            const uint32_t vertex = new_cache[i];
+            for (uint32_t j = 0; j < remaining_triangles[vertex]; j++) {
+                const uint32_t other_triangle = vertex_triangles[triangle_offsets[vertex] + j];
+                const float score = get_triangle_score(other_triangle);
+                if (score > best_score) {
+                    best_score = score;
+                    best_triangle = other_triangle;
+                }
+            }
+        }
+
+        cache_count = std::min(new_cache_count, k_cache_size);
+        std::copy_n(new_cache.begin(), cache_count, cache.begin());
+    }
+    std::ranges::copy(optimized, indices.begin());
+}
+
+auto optimize_vertex_fetch(Mesh& mesh) -> void
+{
+    std::vector<uint32_t> remap(mesh.vertices.size() / 3, k_no_vertex);
+    uint32_t used_vertex_count{0};
+    for (uint32_t& index : mesh.indices) {
+        if (remap[index] == k_no_vertex) {
+            remap[index] = used_vertex_count++;
+        }
+        index = remap[index];
+    }
+    remap_vertices(mesh, remap, used_vertex_count);
+}
+
+auto optimize(Mesh& mesh) -> void
+{
+    remove_duplicate_vertices(mesh);
+    optimize_vertex_cache(mesh.indices, mesh.vertices.size() / 3);
+    optimize_vertex_fetch(mesh);
+}
+
+auto get_average_cache_miss_ratio(std::span<const uint32_t> indices, size_t vertex_count, size_t cache_size)
+    -> float
+{
+    if (indices.size() < 3) {
+        return 0.0f;
+    }
+    // a vertex stays cached until cache_size more misses pushed it out
+    std::vector<size_t> cached_at_miss(vertex_count, 0);
+    // counts from cache_size so a vertex never cached is a miss too
+    size_t miss_count{cache_size};
+    for (const uint32_t index : indices) {
+        if (miss_count - cached_at_miss[index] >= cache_size) {
+            cached_at_miss[index] = miss_count++;
+        }
+    }
+    return static_cast<float>(miss_count - cache_size) / static_cast<float>(indices.size() / 3);
+}
+} // namespace mesh_optimize
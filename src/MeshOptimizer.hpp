@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Mesh.hpp"
+
+// Reorders meshes for the gpu without changing what they look like. Meant to
+// run once when a mesh is loaded or baked, not per frame.
+namespace mesh_optimize
+{
+// entries of the post transform vertex cache the triangle order is tuned for
+inline constexpr size_t k_cache_size = 32;
+
+// merges vertices with exactly the same position and color and points the indices at the merged ones
+auto remove_duplicate_vertices(Mesh& mesh) -> void;
+// Reorders triangles so consecutive ones reuse vertices still in the post
+// transform cache, with Forsyth's linear speed vertex cache optimisation.
+// Triangles keep their winding.
+auto optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count) -> void;
+// renumbers vertices in the order the indices first use them so fetches walk memory forward, drops unused vertices
+auto optimize_vertex_fetch(Mesh& mesh) -> void;
+// all of the above in order
+auto optimize(Mesh& mesh) -> void;
+
+// Vertices transformed per triangle with a FIFO cache of cache_size
+// entries. 3 is the worst, regular grids approach 0.5.
+auto get_average_cache_miss_ratio(std::span<const uint32_t> indices, size_t vertex_count, size_t cache_size)
+    -> float;
+} // namespace mesh_optimize
@@ -0,0 +1,162 @@
+#include "MeshRegistry.hpp"
+
+#include <format>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "Logger.hpp"
+#include "MeshImporter.hpp"
+#include "MeshOptimizer.hpp"
+
+MeshRegistry::MeshRegistry(Mesh::PositionFormat position_format, std::filesystem::path asset_directory,
+    std::filesystem::path cache_directory) :
+    position_format_{position_format}, asset_directory_{std::move(asset_directory)},
+    cache_directory_{std::move(cache_directory)}, entries_{}, handles_{}
+{
+}
+
+auto MeshRegistry::load(std::string_view mesh_name) -> std::optional<MeshHandle>
+{
+    const auto handle_it = handles_.find(mesh_name);
+    if (handle_it != handles_.end()) [[likely]] {
+        return handle_it->second;
+    }
+
+    Entry entry{
+        .name = std::string{mesh_name},
+        .baked{},
+        .vertices{},
+        .indices{},
+        .index_type = GL_UNSIGNED_SHORT,
+        .bounds{},
+        .bounding_sphere{},
+        .lods{},
+        .lod_meshes{},
+    };
+    if (!load_file(mesh_name, entry)) {
+        auto mesh = Mesh::load(mesh_name);
+        if (!mesh) [[unlikely]] {
+            return std::nullopt;
+        }
+        mesh_optimize::optimize(*mesh);
+        set_mesh(std::move(*mesh), entry);
+    }
+
+    const MeshHandle handle{static_cast<uint32_t>(entries_.size())};
+    Entry& stored_entry = entries_.emplace_back(std::move(entry));
+    // registered before its lods so a level naming the mesh again finds it
+    handles_.emplace(stored_entry.name, handle);
+
+    // a level that can not be loaded drops it and every coarser level
+    for (size_t level = 0; level < stored_entry.lods.size(); level++) {
+        const auto lod = load(stored_entry.lods[level].mesh_name);
+        if (!lod) [[unlikely]] {
+            Logger::get_default()->warning(
+                std::format("Dropping levels of detail of mesh {} from level {} on.", mesh_name, level + 1));
+            stored_entry.lods.resize(level);
+            break;
+        }
+        stored_entry.lod_meshes.push_back(*lod);
+    }
+    return handle;
+}
+
+auto MeshRegistry::get_vertices(MeshHandle mesh) const -> std::span<const std::byte>
+{
+    const Entry& entry = entries_[mesh.index];
+    return entry.baked ? entry.baked->get_vertices() : std::span<const std::byte>{entry.vertices};
+}
+
+auto MeshRegistry::get_indices(MeshHandle mesh) const -> std::span<const std::byte>
+{
+    const Entry& entry = entries_[mesh.index];
+    return entry.baked ? entry.baked->get_indices() : std::span<const std::byte>{entry.indices};
+}
+
+auto MeshRegistry::get_index_type(MeshHandle mesh) const -> GLenum
+{
+    const Entry& entry = entries_[mesh.index];
+    return entry.baked ? entry.baked->get_index_type() : entry.index_type;
+}
+
+auto MeshRegistry::get_bounds(MeshHandle mesh) const -> const Aabb&
+{
+    return entries_[mesh.index].bounds;
+}
+
+auto MeshRegistry::get_bounding_sphere(MeshHandle mesh) const -> const Mesh::BoundingSphere&
+{
+    return entries_[mesh.index].bounding_sphere;
+}
+
+auto MeshRegistry::get_lods(MeshHandle mesh) const -> std::span<const Mesh::Lod>
+{
+    return entries_[mesh.index].lods;
+}
+
+auto MeshRegistry::get_lod(MeshHandle mesh, size_t level) const -> MeshHandle
+{
+    return level == 0 ? mesh : entries_[mesh.index].lod_meshes[level - 1];
+}
+
+auto MeshRegistry::get_position_format() const -> Mesh::PositionFormat
+{
+    return position_format_;
+}
+
+auto MeshRegistry::size() const -> size_t
+{
+    return entries_.size();
+}
+
+auto MeshRegistry::load_file(std::string_view mesh_name, Entry& entry) const -> bool
+{
+    if (asset_directory_.empty()) {
+        return false;
+    }
+    for (const std::string_view extension : mesh_import::k_extensions) {
+        const std::filesystem::path source_path = asset_directory_ / std::string{mesh_name}.append(extension);
+        const auto source_stamp = BakedMesh::SourceStamp::of(source_path);
+        if (!source_stamp) {
+            continue;
+        }
+
+        // warm start, the baked mesh is mapped without parsing anything
+        const std::filesystem::path baked_path = cache_directory_ / std::string{mesh_name}.append(k_baked_extension);
+        auto baked = BakedMesh::open(baked_path, position_format_, *source_stamp);
+        if (!baked) {
+            auto mesh = mesh_import::from_file(source_path);
+            if (!mesh) [[unlikely]] {
+                return false;
+            }
+            mesh_optimize::optimize(*mesh);
+            Logger::get_default()->info(std::format("Baking mesh {} to {}.", mesh_name, baked_path.string()));
+            std::error_code error;
+            std::filesystem::create_directories(baked_path.parent_path(), error);
+            if (BakedMesh::write(baked_path, *mesh, position_format_, *source_stamp)) [[likely]] {
+                baked = BakedMesh::open(baked_path, position_format_, *source_stamp);
+            }
+            // keep the imported mesh if the cache is not writable
+            if (!baked) [[unlikely]] {
+                set_mesh(std::move(*mesh), entry);
+                return true;
+            }
+        }
+        entry.bounds = baked->get_bounds();
+        entry.bounding_sphere = baked->get_bounding_sphere();
+        entry.baked = std::move(baked);
+        return true;
+    }
+    return false;
+}
+
+auto MeshRegistry::set_mesh(Mesh&& mesh, Entry& entry) const -> void
+{
+    entry.vertices = mesh.pack_vertices(position_format_);
+    entry.indices = mesh.pack_indices();
+    entry.index_type = mesh.get_index_type();
+    entry.bounds = mesh.local_bounds();
+    entry.bounding_sphere = mesh.local_bounding_sphere();
+    entry.lods = std::move(mesh.lods);
+}
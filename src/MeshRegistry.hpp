@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "Aabb.hpp"
+#include "BakedMesh.hpp"
+#include "Mesh.hpp"
+
+// names a mesh of a MeshRegistry, handles are numbered from 0 in load order
+struct MeshHandle {
+    uint32_t index;
+
+    auto operator==(const MeshHandle&) const -> bool = default;
+};
+
+// Owns every mesh loaded so far, packed for upload in a single position
+// format. Names are only looked up when loading, everything after goes
+// through handles that index straight into storage whose meshes never move,
+// so spans of their data stay valid.
+//
+// A mesh named "a/b" is imported from a/b.glb or a/b.obj in the asset
+// directory and baked into the cache directory. Later loads map the baked
+// mesh as long as the source file is unchanged. Names without a file are
+// looked up in the meshes built into Mesh. Every mesh is run through
+// mesh_optimize before it is packed.
+class MeshRegistry {
+public:
+    // without an asset directory only built in meshes are loaded
+    explicit MeshRegistry(Mesh::PositionFormat position_format = Mesh::PositionFormat::float32,
+        std::filesystem::path asset_directory = {}, std::filesystem::path cache_directory = {});
+
+    MeshRegistry(const MeshRegistry&) = delete;
+    auto operator=(const MeshRegistry&) -> MeshRegistry& = delete;
+
+    // handle of the mesh, loads it and its lods on first use, nothing if the mesh does not exist
+    auto load(std::string_view mesh_name) -> std::optional<MeshHandle>;
+
+    // vertices in the layout of get_position_format
+    auto get_vertices(MeshHandle mesh) const -> std::span<const std::byte>;
+    // indices in the width of get_index_type
+    auto get_indices(MeshHandle mesh) const -> std::span<const std::byte>;
+    // GL_UNSIGNED_SHORT unless the mesh has too many vertices for it
+    auto get_index_type(MeshHandle mesh) const -> GLenum;
+    // bounds and bounding sphere of the mesh in model space, computed once when loaded
+    auto get_bounds(MeshHandle mesh) const -> const Aabb&;
+    auto get_bounding_sphere(MeshHandle mesh) const -> const Mesh::BoundingSphere&;
+    // thresholds for Mesh::select_lod
+    auto get_lods(MeshHandle mesh) const -> std::span<const Mesh::Lod>;
+    // mesh to draw for a level returned by Mesh::select_lod
+    auto get_lod(MeshHandle mesh, size_t level) const -> MeshHandle;
+    auto get_position_format() const -> Mesh::PositionFormat;
+    auto size() const -> size_t;
+
+private:
+    // extension of baked meshes in the cache directory
+    static constexpr std::string_view k_baked_extension = ".mesh";
+
+    struct Entry {
+        std::string name;
+        // data of meshes loaded from a file, the vectors below are empty then
+        std::optional<BakedMesh> baked;
+        std::vector<std::byte> vertices;
+        std::vector<std::byte> indices;
+        GLenum index_type;
+        Aabb bounds;
+        Mesh::BoundingSphere bounding_sphere;
+        std::vector<Mesh::Lod> lods;
+        // handle of every level in lods
+        std::vector<MeshHandle> lod_meshes;
+    };
+
+    Mesh::PositionFormat position_format_;
+    std::filesystem::path asset_directory_;
+    std::filesystem::path cache_directory_;
+    // indexed by handle
+    std::deque<Entry> entries_;
+    // keys view the names in entries_
+    std::unordered_map<std::string_view, MeshHandle> handles_;
+
+    // fills entry from the mesh's file, false if there is no file or it can not be imported
+    auto load_file(std::string_view mesh_name, Entry& entry) const -> bool;
+    auto set_mesh(Mesh&& mesh, Entry& entry) const -> void;
+};
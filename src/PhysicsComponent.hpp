@@ -8,4 +8,15 @@ struct PhysicsComponent {
     Vector3f velocity;
     Vector3f acceleration;
     bool is_affected_by_gravity;
+    // 0 makes the body immovable by collisions
+    float inverse_mass = 1.0f;
+    // sleeping bodies are skipped by the integrator and solver until something wakes them
+    bool is_sleeping = false;
+    // milliseconds the body has been resting
+    float sleep_time = 0.0f;
+    // fast bodies that are swept along their motion every step so they do not pass through thin geometry
+    bool is_bullet = false;
+    // milliseconds and steps skipped by a reduced update rate, made up for on the next step of the body
+    float skipped_time = 0.0f;
+    int skipped_steps = 0;
 };
@@ -0,0 +1,160 @@
+#include "PhysicsIntegrator.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NOT_DOOM_SSE2
+#endif
+
+auto physics::BodyStreams::size() const -> size_t
+{
+    return entity_ids.size();
+}
+
+auto physics::BodyStreams::clear() -> void
+{
+    entity_ids.clear();
+    position_x.clear();
+    position_y.clear();
+    position_z.clear();
+    velocity_x.clear();
+    velocity_y.clear();
+    velocity_z.clear();
+    acceleration_x.clear();
+    acceleration_y.clear();
+    acceleration_z.clear();
+    gravity_factor.clear();
+    time_scale.clear();
+}
+
+auto physics::BodyStreams::push_back(int entity_id, const Vector3f& position, const Vector3f& velocity,
+    const Vector3f& acceleration, bool is_affected_by_gravity, float time_scale, int step_count) -> void
+{
+    entity_ids.push_back(entity_id);
+    position_x.push_back(position.x);
+    position_y.push_back(position.y);
+    position_z.push_back(position.z);
+    velocity_x.push_back(velocity.x);
+    velocity_y.push_back(velocity.y);
+    velocity_z.push_back(velocity.z);
+    acceleration_x.push_back(acceleration.x);
+    acceleration_y.push_back(acceleration.y);
+    acceleration_z.push_back(acceleration.z);
+    gravity_factor.push_back(is_affected_by_gravity ? static_cast<float>(step_count) : 0.0f);
+    this->time_scale.push_back(time_scale);
+}
+
+auto physics::BodyStreams::position(size_t index) const -> Vector3f
+{
+    return {position_x[index], position_y[index], position_z[index]};
+}
+
+auto physics::BodyStreams::velocity(size_t index) const -> Vector3f
+{
+    return {velocity_x[index], velocity_y[index], velocity_z[index]};
+}
+
+auto physics::integrate_scalar(BodyStreams& bodies, size_t begin, size_t end, float delta_time, float gravity) -> void
+{
+    for (size_t i = begin; i < end; i++) {
+        const float dt = delta_time * bodies.time_scale[i];
+        const float half_dt_squared = dt * dt * 0.5f;
+        bodies.position_x[i] += bodies.velocity_x[i] * dt + bodies.acceleration_x[i] * half_dt_squared;
+        bodies.position_y[i] += bodies.velocity_y[i] * dt + bodies.acceleration_y[i] * half_dt_squared;
+        bodies.position_z[i] += bodies.velocity_z[i] * dt + bodies.acceleration_z[i] * half_dt_squared;
+        bodies.velocity_x[i] += bodies.acceleration_x[i] * dt;
+        bodies.velocity_y[i] += bodies.acceleration_y[i] * dt;
+        bodies.velocity_z[i] += bodies.acceleration_z[i] * dt;
+        // separate step so the result matches the simd lanes bit for bit
+        bodies.position_y[i] -= gravity * bodies.gravity_factor[i];
+    }
+}
+
+#if defined(__AVX__)
+namespace
+{
+// integrates 8 bodies starting at i for a single axis
+inline auto integrate_axis(float* position, float* velocity, const float* acceleration, size_t i, __m256 dt,
+    __m256 half_dt_squared) -> void
+{
+    const __m256 p = _mm256_loadu_ps(position + i);
+    const __m256 v = _mm256_loadu_ps(velocity + i);
+    const __m256 a = _mm256_loadu_ps(acceleration + i);
+    const __m256 displacement = _mm256_add_ps(_mm256_mul_ps(v, dt), _mm256_mul_ps(a, half_dt_squared));
+    _mm256_storeu_ps(position + i, _mm256_add_ps(p, displacement));
+    _mm256_storeu_ps(velocity + i, _mm256_add_ps(v, _mm256_mul_ps(a, dt)));
+}
+} // namespace
+
+auto physics::integrate(BodyStreams& bodies, size_t begin, size_t end, float delta_time, float gravity) -> void
+{
+    constexpr size_t k_lanes = 8;
+    const __m256 step_dt = _mm256_set1_ps(delta_time);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 g = _mm256_set1_ps(gravity);
+    size_t i = begin;
+    for (; i + k_lanes <= end; i += k_lanes) {
+        const __m256 dt = _mm256_mul_ps(step_dt, _mm256_loadu_ps(bodies.time_scale.data() + i));
+        const __m256 half_dt_squared = _mm256_mul_ps(_mm256_mul_ps(dt, dt), half);
+        integrate_axis(bodies.position_x.data(), bodies.velocity_x.data(), bodies.acceleration_x.data(), i, dt,
+            half_dt_squared);
+        integrate_axis(bodies.position_y.data(), bodies.velocity_y.data(), bodies.acceleration_y.data(), i, dt,
+            half_dt_squared);
+        integrate_axis(bodies.position_z.data(), bodies.velocity_z.data(), bodies.acceleration_z.data(), i, dt,
+            half_dt_squared);
+        const __m256 y = _mm256_loadu_ps(bodies.position_y.data() + i);
+        const __m256 factor = _mm256_loadu_ps(bodies.gravity_factor.data() + i);
+        _mm256_storeu_ps(bodies.position_y.data() + i, _mm256_sub_ps(y, _mm256_mul_ps(g, factor)));
+    }
+    integrate_scalar(bodies, i, end, delta_time, gravity);
+}
+#elif defined(NOT_DOOM_SSE2)
+namespace
+{
+// integrates 4 bodies starting at i for a single axis
+inline auto integrate_axis(float* position, float* velocity, const float* acceleration, size_t i, __m128 dt,
+    __m128 half_dt_squared) -> void
+{
+    const __m128 p = _mm_loadu_ps(position + i);
+    const __m128 v = _mm_loadu_ps(velocity + i);
+    const __m128 a = _mm_loadu_ps(acceleration + i);
+    const __m128 displacement = _mm_add_ps(_mm_mul_ps(v, dt), _mm_mul_ps(a, half_dt_squared));
+    _mm_storeu_ps(position + i, _mm_add_ps(p, displacement));
+    _mm_storeu_ps(velocity + i, _mm_add_ps(v, _mm_mul_ps(a, dt)));
+}
+} // namespace
+
+auto physics::integrate(BodyStreams& bodies, size_t begin, size_t end, float delta_time, float gravity) -> void
+{
+    constexpr size_t k_lanes = 4;
+    const __m128 step_dt = _mm_set1_ps(delta_time);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 g = _mm_set1_ps(gravity);
+    size_t i = begin;
+    for (; i + k_lanes <= end; i += k_lanes) {
+        const __m128 dt = _mm_mul_ps(step_dt, _mm_loadu_ps(bodies.time_scale.data() + i));
+        const __m128 half_dt_squared = _mm_mul_ps(_mm_mul_ps(dt, dt), half);
+        integrate_axis(bodies.position_x.data(), bodies.velocity_x.data(), bodies.acceleration_x.data(), i, dt,
+            half_dt_squared);
+        integrate_axis(bodies.position_y.data(), bodies.velocity_y.data(), bodies.acceleration_y.data(), i, dt,
+            half_dt_squared);
+        integrate_axis(bodies.position_z.data(), bodies.velocity_z.data(), bodies.acceleration_z.data(), i, dt,
+            half_dt_squared);
+        const __m128 y = _mm_loadu_ps(bodies.position_y.data() + i);
+        const __m128 factor = _mm_loadu_ps(bodies.gravity_factor.data() + i);
+        _mm_storeu_ps(bodies.position_y.data() + i, _mm_sub_ps(y, _mm_mul_ps(g, factor)));
+    }
+    integrate_scalar(bodies, i, end, delta_time, gravity);
+}
+#else
+auto physics::integrate(BodyStreams& bodies, size_t begin, size_t end, float delta_time, float gravity) -> void
+{
+    integrate_scalar(bodies, begin, end, delta_time, gravity);
+}
+#endif
+
+auto physics::integrate(BodyStreams& bodies, float delta_time, float gravity) -> void
+{
+    integrate(bodies, 0, bodies.size(), delta_time, gravity);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Vector3.hpp"
+
+namespace physics
+{
+// Structure of arrays copy of the simulated bodies. Keeping every coordinate
+// in its own contiguous stream lets the integrator process several bodies per
+// instruction.
+struct BodyStreams {
+    std::vector<int> entity_ids;
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> position_z;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> velocity_z;
+    std::vector<float> acceleration_x;
+    std::vector<float> acceleration_y;
+    std::vector<float> acceleration_z;
+    // number of steps of gravity the body takes, 0 if it is not affected by gravity
+    std::vector<float> gravity_factor;
+    // delta time of the body relative to the one passed to integrate, above 1 for bodies that skipped steps
+    std::vector<float> time_scale;
+
+    auto size() const -> size_t;
+    auto clear() -> void;
+    // step_count is the number of steps the body advances by, 1 unless it skipped some
+    auto push_back(int entity_id, const Vector3f& position, const Vector3f& velocity, const Vector3f& acceleration,
+        bool is_affected_by_gravity, float time_scale = 1.0f, int step_count = 1) -> void;
+    auto position(size_t index) const -> Vector3f;
+    auto velocity(size_t index) const -> Vector3f;
+};
+
+// Integrates bodies in [begin, end) over delta_time scaled by their time
+// scale using the widest instruction set the build targets, with a scalar
+// loop for the remainder. gravity times the gravity factor is subtracted
+// from the y position.
+auto integrate(BodyStreams& bodies, size_t begin, size_t end, float delta_time, float gravity) -> void;
+auto integrate(BodyStreams& bodies, float delta_time, float gravity) -> void;
+
+// reference implementation, also used for the tail of the simd loop
+auto integrate_scalar(BodyStreams& bodies, size_t begin, size_t end, float delta_time, float gravity) -> void;
+} // namespace physics
@@ -0,0 +1,97 @@
+#include "PhysicsIslands.hpp"
+
+namespace
+{
+auto find_root(std::vector<int>& parents, int body) -> int
+{
+    while (parents[body] != body) {
+        // path halving
+        parents[body] = parents[parents[body]];
+        body = parents[body];
+    }
+    return body;
+}
+} // namespace
+
+auto physics::Islands::size() const -> size_t
+{
+    return body_offsets.empty() ? 0 : body_offsets.size() - 1;
+}
+
+auto physics::Islands::get_bodies(size_t island) const -> std::span<const int>
+{
+    return std::span<const int>{bodies}.subspan(body_offsets[island], body_offsets[island + 1] - body_offsets[island]);
+}
+
+auto physics::Islands::get_contacts(size_t island) const -> std::span<const int>
+{
+    return std::span<const int>{contacts}.subspan(
+        contact_offsets[island], contact_offsets[island + 1] - contact_offsets[island]);
+}
+
+auto physics::build_islands(size_t body_count, std::span<const std::pair<int, int>> contact_bodies, Islands& islands)
+    -> void
+{
+    // union find, the smaller index always becomes the root so roots are the first body of their island
+    std::vector<int> parents(body_count);
+    for (size_t i = 0; i < body_count; i++) {
+        parents[i] = static_cast<int>(i);
+    }
+    for (const auto& [body_a, body_b] : contact_bodies) {
+        if (body_a < 0 || body_b < 0) {
+            continue;
+        }
+        const int root_a = find_root(parents, body_a);
+        const int root_b = find_root(parents, body_b);
+        if (root_a < root_b) {
+            parents[root_b] = root_a;
+        }
+        else if (root_b < root_a) {
+            parents[root_a] = root_b;
+        }
+    }
+
+    // number islands in order of their roots
+    std::vector<int> island_of_root(body_count, -1);
+    std::vector<int> island_of_body(body_count);
+    size_t island_count{0};
+    for (size_t i = 0; i < body_count; i++) {
+        const int root = find_root(parents, static_cast<int>(i));
+        if (island_of_root[root] == -1) {
+            island_of_root[root] = static_cast<int>(island_count++);
+        }
+        island_of_body[i] = island_of_root[root];
+    }
+
+    // counting sort bodies and contacts into their islands
+    islands.body_offsets.assign(island_count + 1, 0);
+    islands.contact_offsets.assign(island_count + 1, 0);
+    for (size_t i = 0; i < body_count; i++) {
+        islands.body_offsets[island_of_body[i] + 1]++;
+    }
+    const auto get_contact_island = [&island_of_body](const std::pair<int, int>& bodies) {
+        return island_of_body[bodies.first >= 0 ? bodies.first : bodies.second];
+    };
+    for (const auto& bodies : contact_bodies) {
+        if (bodies.first >= 0 || bodies.second >= 0) {
+            islands.contact_offsets[get_contact_island(bodies) + 1]++;
+        }
+    }
+    for (size_t i = 0; i < island_count; i++) {
+        islands.body_offsets[i + 1] += islands.body_offsets[i];
+        islands.contact_offsets[i + 1] += islands.contact_offsets[i];
+    }
+
+    islands.bodies.resize(body_count);
+    islands.contacts.resize(islands.contact_offsets[island_count]);
+    std::vector<size_t> body_cursors(islands.body_offsets.begin(), islands.body_offsets.end() - 1);
+    std::vector<size_t> contact_cursors(islands.contact_offsets.begin(), islands.contact_offsets.end() - 1);
+    for (size_t i = 0; i < body_count; i++) {
+        islands.bodies[body_cursors[island_of_body[i]]++] = static_cast<int>(i);
+    }
+    for (size_t i = 0; i < contact_bodies.size(); i++) {
+        if (contact_bodies[i].first >= 0 || contact_bodies[i].second >= 0) {
+            islands.contacts[contact_cursors[get_contact_island(contact_bodies[i])]++] = static_cast<int>(i);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace physics
+{
+// Groups of bodies connected through contacts, stored as flat arrays. Island
+// i owns bodies[body_offsets[i], body_offsets[i + 1]) and the matching range
+// of contacts.
+struct Islands {
+    std::vector<int> bodies;
+    std::vector<size_t> body_offsets;
+    std::vector<int> contacts;
+    std::vector<size_t> contact_offsets;
+
+    auto size() const -> size_t;
+    auto get_bodies(size_t island) const -> std::span<const int>;
+    auto get_contacts(size_t island) const -> std::span<const int>;
+};
+
+// Builds the islands of body_count bodies where contact i connects the bodies
+// in contact_bodies[i]. Static bodies are given as -1 and do not join the
+// islands of the bodies touching them. Islands are ordered by their first
+// body and list bodies and contacts in increasing order, so the result does
+// not depend on anything but the input order.
+auto build_islands(size_t body_count, std::span<const std::pair<int, int>> contact_bodies, Islands& islands) -> void;
+} // namespace physics
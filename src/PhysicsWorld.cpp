@@ -0,0 +1,569 @@
+#include "PhysicsWorld.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "ColliderComponent.hpp"
+#include "ComponentVector.hpp"
+#include "MeshComponent.hpp"
+#include "PhysicsComponent.hpp"
+#include "TransformComponent.hpp"
+
+namespace
+{
+// sweeping a sphere against a shape is a ray against the shape grown by the radius, boxes grow with square
+// instead of rounded edges which reports impacts at their edges slightly early
+auto grow_shape(collision::Shape shape, float radius) -> collision::Shape
+{
+    shape.half_extents += Vector3f{radius, radius, radius};
+    shape.radius += radius;
+    return shape;
+}
+} // namespace
+
+PhysicsWorld::PhysicsWorld(const MeshRegistry& mesh_registry, size_t worker_count) :
+    mesh_registry_{mesh_registry}, thread_pool_{worker_count}, lod_center_{}, step_count_{0}, bodies_{}, start_positions_{}, bullet_bodies_{}, bullet_corrections_{},
+    entity_to_body_{},
+    broadphase_{k_broadphase_cell_size}, spatial_index_{}, pairs_{}, collidable_entities_{}, collidable_bounds_{},
+    shapes_{}, pair_contacts_{}, contacts_{}, previous_contacts_{}, solver_bodies_{},
+    solver_settings_{}, contact_bodies_{}, islands_{}, sleeping_islands_{}, free_sleeping_islands_{},
+    entity_to_sleeping_island_{}
+{
+}
+
+auto PhysicsWorld::step(ComponentManager& component_manager, float delta_time) -> void
+{
+    integrate(component_manager, delta_time);
+    update_broadphase(component_manager);
+    sweep_bullets(component_manager);
+    broadphase_.find_pairs(pairs_, thread_pool_);
+    find_contacts(component_manager);
+    solve_contacts(component_manager);
+    update_sleep(component_manager, delta_time);
+    step_count_++;
+}
+
+auto PhysicsWorld::set_lod_center(const Vector3f& position) -> void
+{
+    lod_center_ = position;
+}
+
+auto PhysicsWorld::wake(ComponentManager& component_manager, int entity_id) -> void
+{
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+    const auto wake_body = [&physics_vector](int body_entity_id) {
+        PhysicsComponent* physics_component = physics_vector.find_component(body_entity_id);
+        if (physics_component != nullptr) {
+            physics_component->is_sleeping = false;
+            physics_component->sleep_time = 0;
+        }
+    };
+
+    const bool is_in_sleeping_island = static_cast<size_t>(entity_id) < entity_to_sleeping_island_.size()
+        && entity_to_sleeping_island_[entity_id] != k_no_index;
+    if (!is_in_sleeping_island) {
+        wake_body(entity_id);
+        return;
+    }
+    const int island = entity_to_sleeping_island_[entity_id];
+    for (const int island_entity_id : sleeping_islands_[island]) {
+        wake_body(island_entity_id);
+        entity_to_sleeping_island_[island_entity_id] = k_no_index;
+    }
+    sleeping_islands_[island].clear();
+    free_sleeping_islands_.push_back(island);
+}
+
+auto PhysicsWorld::get_pairs() const -> const std::vector<BroadphasePair>&
+{
+    return pairs_;
+}
+
+auto PhysicsWorld::get_contacts() const -> const std::vector<physics::ContactConstraint>&
+{
+    return contacts_;
+}
+
+auto PhysicsWorld::get_spatial_index() const -> const AabbTree&
+{
+    return spatial_index_;
+}
+
+auto PhysicsWorld::raycast(const Vector3f& origin, const Vector3f& direction, float max_distance,
+    const RaycastFilter& filter) const -> std::optional<RaycastHit>
+{
+    std::optional<RaycastHit> closest_hit;
+    spatial_index_.raycast(origin, direction, max_distance, [&](int entity_id, float) {
+        if (filter && !filter(entity_id)) {
+            return max_distance;
+        }
+        const auto hit = collision::raycast(shapes_[entity_id], origin, direction, max_distance);
+        if (hit) {
+            max_distance = hit->distance;
+            closest_hit = RaycastHit{
+                .entity_id = entity_id,
+                .distance = hit->distance,
+                .point = origin + direction * hit->distance,
+                .normal = hit->normal,
+            };
+        }
+        return max_distance;
+    });
+    return closest_hit;
+}
+
+auto PhysicsWorld::sphere_cast(const Vector3f& origin, float radius, const Vector3f& direction, float max_distance,
+    const RaycastFilter& filter) const -> std::optional<RaycastHit>
+{
+    std::optional<RaycastHit> closest_hit;
+    spatial_index_.sphere_cast(origin, radius, direction, max_distance, [&](int entity_id, float) {
+        if (filter && !filter(entity_id)) {
+            return max_distance;
+        }
+        const auto hit = collision::raycast(grow_shape(shapes_[entity_id], radius), origin, direction, max_distance);
+        if (hit) {
+            max_distance = hit->distance;
+            closest_hit = RaycastHit{
+                .entity_id = entity_id,
+                .distance = hit->distance,
+                .point = origin + direction * hit->distance - hit->normal * radius,
+                .normal = hit->normal,
+            };
+        }
+        return max_distance;
+    });
+    return closest_hit;
+}
+
+auto PhysicsWorld::raycast(std::span<const Ray> rays, std::span<std::optional<RaycastHit>> hits,
+    const RaycastFilter& filter) -> void
+{
+    assert(hits.size() >= rays.size() && "Every ray needs a hit");
+    const size_t packet_count = (rays.size() + RayPacket::k_size - 1) / RayPacket::k_size;
+    thread_pool_.parallel_for(packet_count, k_ray_packets_per_task, [&](size_t begin, size_t end) {
+        for (size_t packet_index = begin; packet_index < end; packet_index++) {
+            const size_t first_ray = packet_index * RayPacket::k_size;
+            RayPacket packet;
+            for (size_t lane = 0; lane < RayPacket::k_size; lane++) {
+                // lanes past the last ray stay unused
+                const bool is_used = first_ray + lane < rays.size();
+                const Ray& ray = rays[is_used ? first_ray + lane : first_ray];
+                packet.origin_x[lane] = ray.origin.x;
+                packet.origin_y[lane] = ray.origin.y;
+                packet.origin_z[lane] = ray.origin.z;
+                packet.inverse_direction_x[lane] = AabbTree::get_inverse_direction(ray.direction.x);
+                packet.inverse_direction_y[lane] = AabbTree::get_inverse_direction(ray.direction.y);
+                packet.inverse_direction_z[lane] = AabbTree::get_inverse_direction(ray.direction.z);
+                packet.max_distance[lane] = is_used ? ray.max_distance : -1.0f;
+                if (is_used) {
+                    hits[first_ray + lane].reset();
+                }
+            }
+
+            spatial_index_.raycast(packet, [&](size_t lane, int entity_id, float) {
+                const size_t ray_index = first_ray + lane;
+                const Ray& ray = rays[ray_index];
+                const float max_distance = packet.max_distance[lane];
+                if (filter && !filter(entity_id)) {
+                    return max_distance;
+                }
+                const auto hit = collision::raycast(shapes_[entity_id], ray.origin, ray.direction, max_distance);
+                if (!hit) {
+                    return max_distance;
+                }
+                hits[ray_index] = RaycastHit{
+                    .entity_id = entity_id,
+                    .distance = hit->distance,
+                    .point = ray.origin + ray.direction * hit->distance,
+                    .normal = hit->normal,
+                };
+                // a hit at distance 0 would stop the lane, which is fine since nothing can be closer
+                return hit->distance;
+            });
+        }
+    });
+}
+
+auto PhysicsWorld::integrate(ComponentManager& component_manager, float delta_time) -> void
+{
+    auto& transform_vector = component_manager.get_components<TransformComponent>();
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+
+    for (const int entity_id : bodies_.entity_ids) {
+        entity_to_body_[entity_id] = k_no_index;
+    }
+
+    // copy awake bodies into contiguous streams so they can be integrated in batches
+    bodies_.clear();
+    start_positions_.clear();
+    bullet_bodies_.clear();
+    for (auto& physics_component : physics_vector) {
+        if (physics_component.is_sleeping) [[likely]] {
+            // something outside of physics set the body in motion
+            const Vector3f& v = physics_component.velocity;
+            const Vector3f& a = physics_component.acceleration;
+            if (v.x == 0 && v.y == 0 && v.z == 0 && a.x == 0 && a.y == 0 && a.z == 0) {
+                continue;
+            }
+            wake(component_manager, physics_component.entity_id);
+        }
+        const auto& transform_component = *transform_vector.find_component(physics_component.entity_id);
+        // far bodies take a step every few steps, offset by their id so they do not all step on the same one
+        const uint32_t step_interval = get_step_interval(transform_component.position);
+        if ((step_count_ + static_cast<uint32_t>(physics_component.entity_id)) % step_interval != 0) {
+            physics_component.skipped_time += delta_time;
+            physics_component.skipped_steps++;
+            continue;
+        }
+        const float time_scale
+            = delta_time > 0 ? (delta_time + physics_component.skipped_time) / delta_time : 1.0f;
+        const int step_count = physics_component.skipped_steps + 1;
+        physics_component.skipped_time = 0;
+        physics_component.skipped_steps = 0;
+
+        if (static_cast<size_t>(physics_component.entity_id) >= entity_to_body_.size()) [[unlikely]] {
+            entity_to_body_.resize(physics_component.entity_id + 1, k_no_index);
+        }
+        entity_to_body_[physics_component.entity_id] = static_cast<int>(bodies_.size());
+        if (physics_component.is_bullet) [[unlikely]] {
+            bullet_bodies_.push_back(static_cast<int>(bodies_.size()));
+        }
+        bodies_.push_back(physics_component.entity_id, transform_component.position, physics_component.velocity,
+            physics_component.acceleration, physics_component.is_affected_by_gravity, time_scale, step_count);
+        start_positions_.push_back(transform_component.position);
+    }
+
+    // bodies are independent, every task integrates and writes back its own range
+    thread_pool_.parallel_for(bodies_.size(), k_bodies_per_task, [&](size_t begin, size_t end) {
+        physics::integrate(bodies_, begin, end, delta_time, PhysicsComponent::k_gravity);
+        for (size_t i = begin; i < end; i++) {
+            const int entity_id = bodies_.entity_ids[i];
+            transform_vector.find_component(entity_id)->position = bodies_.position(i);
+            physics_vector.find_component(entity_id)->velocity = bodies_.velocity(i);
+        }
+    });
+}
+
+auto PhysicsWorld::update_broadphase(ComponentManager& component_manager) -> void
+{
+    auto& transform_vector = component_manager.get_components<TransformComponent>();
+    auto& mesh_vector = component_manager.get_components<MeshComponent>();
+    auto& collider_vector = component_manager.get_components<ColliderComponent>();
+
+    // drop entities that lost their mesh since the last step
+    for (const int entity_id : collidable_entities_) {
+        if (mesh_vector.find_component(entity_id) == nullptr) [[unlikely]] {
+            broadphase_.remove(entity_id);
+            spatial_index_.remove(entity_id);
+        }
+    }
+
+    // every entity with a mesh collides, start from the local bounds of its mesh
+    collidable_entities_.clear();
+    collidable_bounds_.clear();
+    for (const auto& mesh_component : mesh_vector) {
+        if (transform_vector.find_component(mesh_component.entity_id) == nullptr) [[unlikely]] {
+            continue;
+        }
+        if (static_cast<size_t>(mesh_component.entity_id) >= shapes_.size()) [[unlikely]] {
+            shapes_.resize(mesh_component.entity_id + 1);
+        }
+        collidable_entities_.push_back(mesh_component.entity_id);
+        collidable_bounds_.push_back(mesh_registry_.get_bounds(mesh_component.mesh));
+    }
+
+    // move shapes and bounds to world space, the narrowphase only reads the shapes afterwards
+    thread_pool_.parallel_for(collidable_entities_.size(), k_bodies_per_task, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const int entity_id = collidable_entities_[i];
+            const TransformComponent& transform = *transform_vector.find_component(entity_id);
+            const ColliderComponent* collider = collider_vector.find_component(entity_id);
+            const auto shape_type = collider ? collider->shape : ColliderComponent::Shape::box;
+            shapes_[entity_id] = collision::make_shape(shape_type, collidable_bounds_[i], transform);
+            collidable_bounds_[i] = Aabb::from_transform(collidable_bounds_[i], transform);
+        }
+    });
+
+    // bounds only move between cells when they cross a cell boundary
+    for (size_t i = 0; i < collidable_entities_.size(); i++) {
+        broadphase_.update(collidable_entities_[i], collidable_bounds_[i]);
+        spatial_index_.update(collidable_entities_[i], collidable_bounds_[i]);
+    }
+}
+
+auto PhysicsWorld::sweep_bullets(ComponentManager& component_manager) -> void
+{
+    auto& transform_vector = component_manager.get_components<TransformComponent>();
+
+    // sweeps only read the shapes, corrections are applied afterwards so bullets see each other's end positions
+    bullet_corrections_.resize(bullet_bodies_.size());
+    thread_pool_.parallel_for(bullet_bodies_.size(), k_bodies_per_task, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const int body_index = bullet_bodies_[i];
+            const Vector3f motion = bodies_.position(body_index) - start_positions_[body_index];
+            const float distance = motion.length();
+            const float time_of_impact = get_time_of_impact(body_index);
+            bullet_corrections_[i]
+                = time_of_impact < distance ? motion * ((time_of_impact - distance) / distance) : Vector3f{};
+        }
+    });
+
+    for (size_t i = 0; i < bullet_bodies_.size(); i++) {
+        const Vector3f& correction = bullet_corrections_[i];
+        if (correction.x == 0 && correction.y == 0 && correction.z == 0) [[likely]] {
+            continue;
+        }
+        const int entity_id = bodies_.entity_ids[bullet_bodies_[i]];
+        transform_vector.find_component(entity_id)->position += correction;
+        shapes_[entity_id].center += correction;
+        // the bullet now touches what it hit, so the discrete contact of this step resolves the impact
+        const Aabb bounds{broadphase_.get_bounds(entity_id).min + correction,
+            broadphase_.get_bounds(entity_id).max + correction};
+        broadphase_.update(entity_id, bounds);
+        spatial_index_.update(entity_id, bounds);
+    }
+}
+
+auto PhysicsWorld::get_time_of_impact(int body_index) const -> float
+{
+    const int entity_id = bodies_.entity_ids[body_index];
+    const Vector3f motion = bodies_.position(body_index) - start_positions_[body_index];
+    const float distance = motion.length();
+    // bullets without a mesh do not collide
+    if (!broadphase_.contains(entity_id)) {
+        return distance;
+    }
+
+    // The bullet is swept as the largest sphere inside its shape. Moving
+    // less than that radius it overlaps whatever it passes and the discrete
+    // contacts catch it.
+    const collision::Shape& shape = shapes_[entity_id];
+    const float radius = shape.type == ColliderComponent::Shape::sphere
+        ? shape.radius
+        : std::min({shape.half_extents.x, shape.half_extents.y, shape.half_extents.z});
+    if (distance <= radius) [[likely]] {
+        return distance;
+    }
+
+    const Vector3f direction = motion / distance;
+    const Vector3f start_center = shape.center - motion;
+    const Aabb& end_bounds = broadphase_.get_bounds(entity_id);
+    const Aabb swept_bounds = end_bounds.merged({end_bounds.min - motion, end_bounds.max - motion});
+    float time_of_impact = distance;
+    bool is_hit{false};
+    spatial_index_.query(swept_bounds, [&](int other_entity_id) {
+        if (other_entity_id == entity_id) {
+            return true;
+        }
+        const auto hit
+            = collision::raycast(grow_shape(shapes_[other_entity_id], radius), start_center, direction, time_of_impact);
+        if (!hit) {
+            return true;
+        }
+        // Starting in touch is an impact right away if the bullet moves into
+        // the shape, it would pass through a thin one otherwise. Sliding
+        // along or moving away from it is not.
+        if (hit->distance == 0) {
+            collision::Shape start_shape = shape;
+            start_shape.center = start_center;
+            const auto contact = collision::collide(start_shape, shapes_[other_entity_id]);
+            if (!contact || contact->normal.dot(direction) <= 0) {
+                return true;
+            }
+        }
+        time_of_impact = hit->distance;
+        is_hit = true;
+        return true;
+    });
+    return is_hit ? std::min(time_of_impact + k_bullet_contact_depth, distance) : distance;
+}
+
+auto PhysicsWorld::get_step_interval(const Vector3f& position) const -> uint32_t
+{
+    const Vector3f offset = position - lod_center_;
+    const float distance_squared = offset.dot(offset);
+    uint32_t step_interval{1};
+    for (const LodTier& tier : k_lod_tiers) {
+        if (distance_squared < tier.min_distance * tier.min_distance) {
+            break;
+        }
+        step_interval = tier.step_interval;
+    }
+    return step_interval;
+}
+
+auto PhysicsWorld::get_solver_body(int entity_id) const -> int
+{
+    const bool is_awake_body = static_cast<size_t>(entity_id) < entity_to_body_.size()
+        && entity_to_body_[entity_id] != k_no_index;
+    return is_awake_body ? entity_to_body_[entity_id] + 1 : k_static_solver_body;
+}
+
+auto PhysicsWorld::find_contacts(ComponentManager& component_manager) -> void
+{
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+    auto& collider_vector = component_manager.get_components<ColliderComponent>();
+
+    std::swap(contacts_, previous_contacts_);
+    contacts_.clear();
+
+    // every pair is tested on its own, results land in the slot of the pair
+    pair_contacts_.resize(pairs_.size());
+    thread_pool_.parallel_for(pairs_.size(), k_pairs_per_task, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const BroadphasePair& pair = pairs_[i];
+            // Only bodies stepped this step take part in the solve. Static
+            // geometry, sleeping bodies and bodies skipping the step all act
+            // as the static solver body, so a contact between two of them
+            // would never be solved.
+            if (get_solver_body(pair.entity_a) == k_static_solver_body
+                && get_solver_body(pair.entity_b) == k_static_solver_body) [[likely]] {
+                pair_contacts_[i].reset();
+                continue;
+            }
+            pair_contacts_[i] = collision::collide(shapes_[pair.entity_a], shapes_[pair.entity_b]);
+        }
+    });
+
+    // waking islands changes components, so contacts are collected on this thread in pair order which keeps
+    // them sorted
+    for (size_t i = 0; i < pairs_.size(); i++) {
+        const auto& contact = pair_contacts_[i];
+        if (!contact) [[likely]] {
+            continue;
+        }
+        const BroadphasePair& pair = pairs_[i];
+        const PhysicsComponent* physics_a = physics_vector.find_component(pair.entity_a);
+        const PhysicsComponent* physics_b = physics_vector.find_component(pair.entity_b);
+
+        // an awake body touched a sleeping island, it takes part in the solve from the next step
+        if (physics_a != nullptr && physics_a->is_sleeping) {
+            wake(component_manager, pair.entity_a);
+            continue;
+        }
+        if (physics_b != nullptr && physics_b->is_sleeping) {
+            wake(component_manager, pair.entity_b);
+            continue;
+        }
+
+        const ColliderComponent* collider_a = collider_vector.find_component(pair.entity_a);
+        const ColliderComponent* collider_b = collider_vector.find_component(pair.entity_b);
+        contacts_.push_back({
+            .entity_a = pair.entity_a,
+            .entity_b = pair.entity_b,
+            .body_a = get_solver_body(pair.entity_a),
+            .body_b = get_solver_body(pair.entity_b),
+            .normal = contact->normal,
+            .penetration = contact->penetration,
+            .restitution = std::max(collider_a ? collider_a->restitution : 0.0f,
+                collider_b ? collider_b->restitution : 0.0f),
+            .normal_impulse = 0,
+            .effective_mass = 0,
+            .velocity_bias = 0,
+        });
+    }
+}
+
+auto PhysicsWorld::solve_contacts(ComponentManager& component_manager) -> void
+{
+    auto& transform_vector = component_manager.get_components<TransformComponent>();
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+
+    solver_bodies_.resize(bodies_.size() + 1);
+    solver_bodies_[k_static_solver_body] = {.velocity = {}, .position_correction = {}, .inverse_mass = 0};
+    thread_pool_.parallel_for(bodies_.size(), k_bodies_per_task, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            solver_bodies_[i + 1] = {
+                .velocity = bodies_.velocity(i),
+                .position_correction = {},
+                .inverse_mass = physics_vector.find_component(bodies_.entity_ids[i])->inverse_mass,
+            };
+        }
+    });
+
+    physics::warm_start_contacts(contacts_, previous_contacts_);
+
+    contact_bodies_.clear();
+    for (const physics::ContactConstraint& contact : contacts_) {
+        contact_bodies_.emplace_back(contact.body_a - 1, contact.body_b - 1);
+    }
+    physics::build_islands(bodies_.size(), contact_bodies_, islands_);
+
+    // islands share no dynamic bodies, so they are solved concurrently, each one in the same order on a single
+    // thread no matter how they are distributed
+    thread_pool_.parallel_for(islands_.size(), k_islands_per_task, [&](size_t begin, size_t end) {
+        for (size_t island = begin; island < end; island++) {
+            const auto island_contacts = islands_.get_contacts(island);
+            // bodies without contacts are unchanged
+            if (island_contacts.empty()) {
+                continue;
+            }
+            physics::solve_contacts(contacts_, island_contacts, solver_bodies_, solver_settings_);
+            for (const int body_index : islands_.get_bodies(island)) {
+                const physics::SolverBody& body = solver_bodies_[body_index + 1];
+                const int entity_id = bodies_.entity_ids[body_index];
+                physics_vector.find_component(entity_id)->velocity = body.velocity;
+                transform_vector.find_component(entity_id)->position += body.position_correction;
+                // keeps shapes in sync for queries between steps
+                shapes_[entity_id].center += body.position_correction;
+            }
+        }
+    });
+}
+
+auto PhysicsWorld::update_sleep(ComponentManager& component_manager, float delta_time) -> void
+{
+    auto& transform_vector = component_manager.get_components<TransformComponent>();
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+
+    // gravity moves bodies without changing their velocity, so both are checked
+    const float max_speed_squared = k_sleep_speed * k_sleep_speed;
+    thread_pool_.parallel_for(bodies_.size(), k_bodies_per_task, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const int entity_id = bodies_.entity_ids[i];
+            PhysicsComponent& physics_component = *physics_vector.find_component(entity_id);
+            // bodies with a reduced update rate moved over several steps worth of time
+            const float body_delta_time = delta_time * bodies_.time_scale[i];
+            const float max_displacement = k_sleep_speed * body_delta_time;
+            const Vector3f displacement = transform_vector.find_component(entity_id)->position - start_positions_[i];
+            const bool is_resting = physics_component.velocity.dot(physics_component.velocity) < max_speed_squared
+                && displacement.dot(displacement) < max_displacement * max_displacement;
+            physics_component.sleep_time = is_resting ? physics_component.sleep_time + body_delta_time : 0;
+        }
+    });
+
+    // islands come from the solve, they only sleep as a whole so a resting body on a moving one stays awake
+    for (size_t island = 0; island < islands_.size(); island++) {
+        const auto island_bodies = islands_.get_bodies(island);
+        const bool can_sleep = std::all_of(island_bodies.begin(), island_bodies.end(), [&](int body_index) {
+            return physics_vector.find_component(bodies_.entity_ids[body_index])->sleep_time >= k_time_to_sleep;
+        });
+        if (!can_sleep) {
+            continue;
+        }
+
+        int sleeping_island;
+        if (free_sleeping_islands_.empty()) {
+            sleeping_island = static_cast<int>(sleeping_islands_.size());
+            sleeping_islands_.emplace_back();
+        }
+        else {
+            sleeping_island = free_sleeping_islands_.back();
+            free_sleeping_islands_.pop_back();
+        }
+        for (const int body_index : island_bodies) {
+            const int entity_id = bodies_.entity_ids[body_index];
+            PhysicsComponent& physics_component = *physics_vector.find_component(entity_id);
+            physics_component.is_sleeping = true;
+            physics_component.velocity = {};
+            if (static_cast<size_t>(entity_id) >= entity_to_sleeping_island_.size()) {
+                entity_to_sleeping_island_.resize(entity_id + 1, k_no_index);
+            }
+            entity_to_sleeping_island_[entity_id] = sleeping_island;
+            sleeping_islands_[sleeping_island].push_back(entity_id);
+        }
+    }
+}
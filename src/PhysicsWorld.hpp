@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Aabb.hpp"
+#include "AabbTree.hpp"
+#include "Collision.hpp"
+#include "ComponentManager.hpp"
+#include "ContactSolver.hpp"
+#include "MeshRegistry.hpp"
+#include "PhysicsComponent.hpp"
+#include "PhysicsIntegrator.hpp"
+#include "PhysicsIslands.hpp"
+#include "SpatialHashGrid.hpp"
+#include "ThreadPool.hpp"
+#include "Vector3.hpp"
+
+struct Ray {
+    Vector3f origin;
+    // normalized
+    Vector3f direction;
+    float max_distance;
+};
+
+struct RaycastHit {
+    int entity_id;
+    float distance;
+    Vector3f point;
+    // surface normal at point, facing against the ray
+    Vector3f normal;
+};
+
+// Owns the state of the physics pipeline that has to persist between frames
+// and runs all of its stages on the registered components. Stages are split
+// between worker threads by body, pair and island in a way that gives the
+// same result for any number of threads.
+class PhysicsWorld {
+public:
+    // bodies moving slower than this, in units per millisecond, count as resting
+    static constexpr float k_sleep_speed = 0.0005f;
+    // milliseconds an island has to rest before it is put to sleep
+    static constexpr float k_time_to_sleep = 500.0f;
+
+    // bodies at least min_distance away from the lod center are only stepped every step_interval steps
+    struct LodTier {
+        float min_distance;
+        uint32_t step_interval;
+    };
+    // sorted by distance, the first tier covers every distance
+    static constexpr std::array<LodTier, 3> k_lod_tiers{{
+        {.min_distance = 0.0f, .step_interval = 1},
+        {.min_distance = 64.0f, .step_interval = 2},
+        {.min_distance = 128.0f, .step_interval = 4},
+    }};
+
+    // colliders of entities with a mesh start from the mesh's bounds in mesh_registry
+    explicit PhysicsWorld(const MeshRegistry& mesh_registry,
+        size_t worker_count = ThreadPool::get_default_worker_count());
+
+    auto step(ComponentManager& component_manager, float delta_time) -> void;
+    // position the distance of bodies for their update rate is measured from, usually the camera
+    auto set_lod_center(const Vector3f& position) -> void;
+    // wakes the entity and every body sleeping in the same island
+    auto wake(ComponentManager& component_manager, int entity_id) -> void;
+    // broadphase pairs found in the last step
+    auto get_pairs() const -> const std::vector<BroadphasePair>&;
+    // contacts solved in the last step
+    auto get_contacts() const -> const std::vector<physics::ContactConstraint>&;
+    // bounding volume hierarchy of every collidable entity for overlap, frustum and ray queries
+    auto get_spatial_index() const -> const AabbTree&;
+
+    // returns false for entities rays should pass through
+    using RaycastFilter = std::function<bool(int entity_id)>;
+    // Closest hit of the ray with the collision shapes as of the last step.
+    // direction must be normalized.
+    auto raycast(const Vector3f& origin, const Vector3f& direction, float max_distance,
+        const RaycastFilter& filter = {}) const -> std::optional<RaycastHit>;
+    // Closest hit of a sphere of radius moved from origin along direction,
+    // distance is how far its center moved and point where it touches the
+    // shape. Boxes are hit slightly early at their edges.
+    auto sphere_cast(const Vector3f& origin, float radius, const Vector3f& direction, float max_distance,
+        const RaycastFilter& filter = {}) const -> std::optional<RaycastHit>;
+    // Sets hits[i] to the closest hit of rays[i]. Rays are traversed four at
+    // a time and spread over the worker threads, so filter has to be safe to
+    // call concurrently. Must not run at the same time as step.
+    auto raycast(std::span<const Ray> rays, std::span<std::optional<RaycastHit>> hits,
+        const RaycastFilter& filter = {}) -> void;
+
+private:
+    static constexpr float k_broadphase_cell_size = 4.0f;
+    static constexpr int k_no_index = -1;
+    // solver body shared by all static entities, awake body i is solver body i + 1
+    static constexpr int k_static_solver_body = 0;
+    // bullets are left this deep inside what they hit so the discrete contacts see the impact
+    static constexpr float k_bullet_contact_depth = 0.02f;
+    // work handed to a thread at a time by every stage
+    static constexpr size_t k_bodies_per_task = 1024;
+    static constexpr size_t k_pairs_per_task = 256;
+    static constexpr size_t k_islands_per_task = 16;
+    static constexpr size_t k_ray_packets_per_task = 16;
+
+    const MeshRegistry& mesh_registry_;
+    ThreadPool thread_pool_;
+    Vector3f lod_center_;
+    // number of steps taken, staggers the steps of bodies with a reduced update rate
+    uint32_t step_count_;
+
+    // awake bodies of the current step, reused every frame to avoid reallocating the streams
+    physics::BodyStreams bodies_;
+    // positions of bodies_ before integration
+    std::vector<Vector3f> start_positions_;
+    // indices into bodies_ of awake bullets, and how far each of them is moved back to its time of impact
+    std::vector<int> bullet_bodies_;
+    std::vector<Vector3f> bullet_corrections_;
+    // index into bodies_ of every entity, k_no_index if it is not an awake body
+    std::vector<int> entity_to_body_;
+    SpatialHashGrid broadphase_;
+    AabbTree spatial_index_;
+    std::vector<BroadphasePair> pairs_;
+    // entities that were in the broadphase after the last step and their world bounds
+    std::vector<int> collidable_entities_;
+    std::vector<Aabb> collidable_bounds_;
+    // collision shape of every collidable entity in the current step, indexed by entity id
+    std::vector<collision::Shape> shapes_;
+    // narrowphase result of every pair in pairs_
+    std::vector<std::optional<collision::Contact>> pair_contacts_;
+    // contacts of this and the last step, sorted by entity ids
+    std::vector<physics::ContactConstraint> contacts_;
+    std::vector<physics::ContactConstraint> previous_contacts_;
+    std::vector<physics::SolverBody> solver_bodies_;
+    physics::SolverSettings solver_settings_;
+    // awake bodies of every contact, -1 for static ones
+    std::vector<std::pair<int, int>> contact_bodies_;
+    physics::Islands islands_;
+    // entities of every island that went to sleep, woken together
+    std::vector<std::vector<int>> sleeping_islands_;
+    std::vector<int> free_sleeping_islands_;
+    // index into sleeping_islands_ of every entity, k_no_index if awake
+    std::vector<int> entity_to_sleeping_island_;
+
+    auto integrate(ComponentManager& component_manager, float delta_time) -> void;
+    auto update_broadphase(ComponentManager& component_manager) -> void;
+    // moves bullets back to where their sweep first touches another collision shape
+    auto sweep_bullets(ComponentManager& component_manager) -> void;
+    auto get_time_of_impact(int body_index) const -> float;
+    auto find_contacts(ComponentManager& component_manager) -> void;
+    auto solve_contacts(ComponentManager& component_manager) -> void;
+    auto update_sleep(ComponentManager& component_manager, float delta_time) -> void;
+    auto get_solver_body(int entity_id) const -> int;
+    auto get_step_interval(const Vector3f& position) const -> uint32_t;
+};
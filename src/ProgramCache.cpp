@@ -0,0 +1,268 @@
+#include "ProgramCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "Logger.hpp"
+#include "Shader.hpp"
+
+namespace
+{
+constexpr uint64_t k_fnv_offset_basis = 14695981039346656037ull;
+constexpr uint64_t k_fnv_prime = 1099511628211ull;
+
+// FNV-1a, continues from hash
+auto hash_bytes(uint64_t hash, std::span<const std::byte> bytes) -> uint64_t
+{
+    for (const std::byte byte : bytes) {
+        hash = (hash ^ static_cast<uint64_t>(byte)) * k_fnv_prime;
+    }
+    return hash;
+}
+
+// hashes the string's length too, so consecutive strings can not run into each other
+auto hash_string(uint64_t hash, std::string_view string) -> uint64_t
+{
+    const uint64_t size = string.size();
+    hash = hash_bytes(hash, std::as_bytes(std::span{&size, 1}));
+    return hash_bytes(hash, std::as_bytes(std::span{string}));
+}
+
+auto get_driver_string(GLenum name) -> std::string_view
+{
+    const GLubyte* string = glGetString(name);
+    return string == nullptr ? std::string_view{} : reinterpret_cast<const char*>(string);
+}
+
+// 16 hex digits
+auto to_hex(uint64_t value) -> std::string
+{
+    std::array<char, 16> digits;
+    const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value, 16);
+    std::string hex(digits.size() - static_cast<size_t>(result.ptr - digits.data()), '0');
+    return hex.append(digits.data(), result.ptr);
+}
+} // namespace
+
+ProgramCache::ProgramCache(std::filesystem::path cache_directory) :
+    cache_directory_{std::move(cache_directory)}, driver_hash_{}, is_caching_{false},
+    is_compiling_in_parallel_{false}, jobs_{}
+{
+}
+
+ProgramCache::~ProgramCache()
+{
+    for (const Job& job : jobs_) {
+        std::for_each(job.shaders.begin(), job.shaders.end(), glDeleteShader);
+        if (job.program != 0) {
+            glDeleteProgram(job.program);
+        }
+    }
+}
+
+auto ProgramCache::submit_program(std::span<const ShaderSource> shader_sources) -> ProgramHandle
+{
+    if (!driver_hash_) [[unlikely]] {
+        uint64_t driver_hash = k_fnv_offset_basis;
+        for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            driver_hash = hash_string(driver_hash, get_driver_string(name));
+        }
+        driver_hash_ = driver_hash;
+        GLint binary_format_count{0};
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_count);
+        is_caching_ = !cache_directory_.empty() && binary_format_count > 0;
+        is_compiling_in_parallel_ = GLEW_KHR_parallel_shader_compile;
+        if (is_compiling_in_parallel_) {
+            // as many compiler threads as the driver wants
+            glMaxShaderCompilerThreadsKHR(0xffffffff);
+        }
+    }
+
+    uint64_t source_hash = k_fnv_offset_basis;
+    for (const ShaderSource& shader_source : shader_sources) {
+        source_hash = hash_bytes(source_hash, std::as_bytes(std::span{&shader_source.type, 1}));
+        source_hash = hash_string(source_hash, shader_source.source);
+    }
+    const ProgramHandle handle{static_cast<uint32_t>(jobs_.size())};
+    Job& job = jobs_.emplace_back(Job{
+        .program = 0,
+        .shaders{},
+        .shader_types{},
+        .source_hash = source_hash,
+        .status = ProgramStatus::compiling,
+    });
+    if (is_caching_) {
+        const auto program = load_binary(get_binary_path(source_hash), source_hash);
+        if (program) {
+            job.program = *program;
+            job.status = ProgramStatus::ready;
+            return handle;
+        }
+    }
+
+    // every stage and the link are queued before anything is queried, so none of them stalls the others
+    for (const ShaderSource& shader_source : shader_sources) {
+        job.shaders.push_back(shader::start_shader(shader_source.source, shader_source.type));
+        job.shader_types.push_back(shader_source.type);
+    }
+    job.program = shader::start_shader_program(job.shaders, is_caching_);
+    if (job.program == 0) [[unlikely]] {
+        finish_program(job);
+    }
+    return handle;
+}
+
+auto ProgramCache::poll_program(ProgramHandle program) -> ProgramStatus
+{
+    Job& job = jobs_[program.index];
+    if (job.status != ProgramStatus::compiling) [[likely]] {
+        return job.status;
+    }
+    if (is_compiling_in_parallel_) {
+        GLint is_complete{GL_FALSE};
+        glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &is_complete);
+        if (is_complete == GL_FALSE) {
+            return ProgramStatus::compiling;
+        }
+    }
+    finish_program(job);
+    return job.status;
+}
+
+auto ProgramCache::get_program(ProgramHandle program) const -> std::optional<GLuint>
+{
+    const Job& job = jobs_[program.index];
+    if (job.status != ProgramStatus::ready) {
+        return std::nullopt;
+    }
+    return job.program;
+}
+
+auto ProgramCache::wait_program(ProgramHandle program) -> std::optional<GLuint>
+{
+    Job& job = jobs_[program.index];
+    if (job.status == ProgramStatus::compiling) {
+        // querying the results waits for the driver
+        finish_program(job);
+    }
+    return get_program(program);
+}
+
+auto ProgramCache::release_program(ProgramHandle program) -> void
+{
+    Job& job = jobs_[program.index];
+    std::for_each(job.shaders.begin(), job.shaders.end(), glDeleteShader);
+    job.shaders.clear();
+    job.shader_types.clear();
+    if (job.program != 0) {
+        glDeleteProgram(job.program);
+        job.program = 0;
+    }
+    job.status = ProgramStatus::failed;
+}
+
+auto ProgramCache::get_binary_path(uint64_t source_hash) const -> std::filesystem::path
+{
+    return cache_directory_ / to_hex(source_hash).append(k_binary_extension);
+}
+
+auto ProgramCache::finish_program(Job& job) -> void
+{
+    // every stage is checked so all of their errors are logged
+    bool is_compiled{true};
+    for (size_t i = 0; i < job.shaders.size(); i++) {
+        is_compiled = shader::check_shader(job.shaders[i], job.shader_types[i]) && is_compiled;
+    }
+    const bool is_linked = job.program != 0 && is_compiled && shader::check_shader_program(job.program, job.shaders);
+    std::for_each(job.shaders.begin(), job.shaders.end(), glDeleteShader);
+    job.shaders.clear();
+    job.shader_types.clear();
+    if (!is_linked) [[unlikely]] {
+        if (job.program != 0) {
+            glDeleteProgram(job.program);
+            job.program = 0;
+        }
+        job.status = ProgramStatus::failed;
+        return;
+    }
+    if (is_caching_) {
+        save_binary(get_binary_path(job.source_hash), job.program, job.source_hash);
+    }
+    job.status = ProgramStatus::ready;
+}
+
+auto ProgramCache::load_binary(const std::filesystem::path& path, uint64_t source_hash) const -> std::optional<GLuint>
+{
+    std::ifstream file{path, std::ios_base::binary};
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return std::nullopt;
+    }
+    const bool is_current = header.magic == k_magic && header.version == k_version
+        && header.driver_hash == *driver_hash_ && header.source_hash == source_hash;
+    if (!is_current) {
+        return std::nullopt;
+    }
+    // the size is checked against the file before allocating, a damaged header could claim anything
+    std::error_code error;
+    const uintmax_t file_size = std::filesystem::file_size(path, error);
+    if (error || file_size != sizeof(header) + header.binary_size) [[unlikely]] {
+        return std::nullopt;
+    }
+    std::vector<char> binary(header.binary_size);
+    if (!file.read(binary.data(), static_cast<std::streamsize>(binary.size()))) [[unlikely]] {
+        return std::nullopt;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+    // drivers may reject binaries they produced themselves, after an update that kept the version string for example
+    GLint link_status{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+    if (link_status == GL_FALSE) [[unlikely]] {
+        Logger::get_default()->info(std::format("Program binary {} was rejected, compiling it again.", path.string()));
+        glDeleteProgram(program);
+        return std::nullopt;
+    }
+    return program;
+}
+
+auto ProgramCache::save_binary(const std::filesystem::path& path, GLuint program, uint64_t source_hash) const -> void
+{
+    GLint binary_size{0};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+    if (binary_size <= 0) [[unlikely]] {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(binary_size));
+    GLenum binary_format{0};
+    glGetProgramBinary(program, binary_size, &binary_size, &binary_format, binary.data());
+    const Header header{
+        .magic = k_magic,
+        .version = k_version,
+        .driver_hash = *driver_hash_,
+        .source_hash = source_hash,
+        .binary_format = binary_format,
+        .binary_size = static_cast<uint32_t>(binary_size),
+    };
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::ofstream file{path, std::ios_base::binary | std::ios_base::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary_size);
+    file.close();
+    if (!file) [[unlikely]] {
+        // a partly written file is rejected by load_binary anyway
+        Logger::get_default()->warning(std::format("Could not write program binary {}.", path.string()));
+    }
+}
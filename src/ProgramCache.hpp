@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+
+// names a program of a ProgramCache, handles are numbered from 0 in submit order
+struct ProgramHandle {
+    uint32_t index;
+
+    auto operator==(const ProgramHandle&) const -> bool = default;
+};
+
+enum class ProgramStatus : uint8_t {
+    compiling,
+    ready,
+    failed,
+};
+
+// Links shader programs and keeps their binaries in a cache directory, so
+// later launches hand the driver a linked binary instead of compiling GLSL.
+// Binaries are keyed by a hash of the shader sources and only used by the
+// driver that produced them. A binary from another driver, or one the driver
+// rejects, is replaced by compiling the sources again.
+//
+// Programs are submitted up front and polled until they are ready. Where
+// KHR_parallel_shader_compile is available the driver compiles them on its
+// own threads meanwhile, elsewhere polling waits for the compile. The cache
+// owns its programs and deletes them when destroyed.
+class ProgramCache {
+public:
+    // source of a stage of a program
+    struct ShaderSource {
+        GLenum type;
+        std::string_view source;
+    };
+
+    // without a cache directory every program is compiled
+    explicit ProgramCache(std::filesystem::path cache_directory = {});
+    // needs the context the programs were created in to be current
+    ~ProgramCache();
+
+    ProgramCache(const ProgramCache&) = delete;
+    auto operator=(const ProgramCache&) -> ProgramCache& = delete;
+
+    // Starts compiling and linking a program of the stages without waiting
+    // for either. Cached binaries are ready right away. Needs a current
+    // context.
+    auto submit_program(std::span<const ShaderSource> shader_sources) -> ProgramHandle;
+    // Status of the program, only waits for the driver without parallel
+    // compiles. Compile and link errors are logged once it is done.
+    auto poll_program(ProgramHandle program) -> ProgramStatus;
+    // the program once poll_program reported it ready, nothing before or if it failed
+    auto get_program(ProgramHandle program) const -> std::optional<GLuint>;
+    // waits until the program is done, nothing if it failed
+    auto wait_program(ProgramHandle program) -> std::optional<GLuint>;
+    // deletes the program before the cache is destroyed, the handle reports failed afterwards
+    auto release_program(ProgramHandle program) -> void;
+
+private:
+    // "PRGM" read as a little endian integer
+    static constexpr uint32_t k_magic = 0x4d475250;
+    // bumped whenever the layout of the file changes
+    static constexpr uint32_t k_version = 1;
+    // extension of cached binaries, named by their source hash
+    static constexpr std::string_view k_binary_extension = ".program";
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t driver_hash;
+        uint64_t source_hash;
+        uint32_t binary_format;
+        uint32_t binary_size;
+    };
+
+    struct Job {
+        GLuint program;
+        // stages still compiling, deleted once the program is done
+        std::vector<GLuint> shaders;
+        std::vector<GLenum> shader_types;
+        uint64_t source_hash;
+        ProgramStatus status;
+    };
+
+    std::filesystem::path cache_directory_;
+    // hash of the vendor, renderer and version strings, read with the first program
+    std::optional<uint64_t> driver_hash_;
+    // false if the driver has no binary formats or there is no cache directory
+    bool is_caching_;
+    // whether the driver reports GL_COMPLETION_STATUS_KHR
+    bool is_compiling_in_parallel_;
+    // indexed by handle
+    std::vector<Job> jobs_;
+
+    auto get_binary_path(uint64_t source_hash) const -> std::filesystem::path;
+    // checks the compile and link results of a program that is done
+    auto finish_program(Job& job) -> void;
+
+    // linked program from the cached binary, nothing if it is missing, stale or rejected
+    auto load_binary(const std::filesystem::path& path, uint64_t source_hash) const -> std::optional<GLuint>;
+    auto save_binary(const std::filesystem::path& path, GLuint program, uint64_t source_hash) const -> void;
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <SDL_render.h>
+#include "ResourceManager.hpp"
 
 struct RenderComponent {
     enum class RenderableType {
@@ -10,7 +10,7 @@ struct RenderComponent {
 
     int entity_id;
     RenderableType type;
-    SDL_Texture* texture;
+    TextureHandle texture;
     double width;
     double height;
 };
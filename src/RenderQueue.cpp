@@ -0,0 +1,94 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+auto RenderQueue::make_key(RenderPass pass, uint32_t shader, bool wide_indices, uint32_t mesh, float depth)
+    -> uint64_t
+{
+    assert(shader < (1u << k_shader_bits) && "Shader index does not fit into a render key");
+    assert(mesh < (1u << k_mesh_bits) && "Mesh index does not fit into a render key");
+    // bits of non negative floats sort like the floats themselves
+    uint32_t depth_bits = std::bit_cast<uint32_t>(std::max(depth, 0.0f));
+    if (pass == RenderPass::transparent) {
+        depth_bits = ~depth_bits;
+    }
+    return static_cast<uint64_t>(pass) << (k_shader_bits + k_wide_indices_bits + k_mesh_bits + k_depth_bits)
+        | static_cast<uint64_t>(shader) << (k_wide_indices_bits + k_mesh_bits + k_depth_bits)
+        | static_cast<uint64_t>(wide_indices) << (k_mesh_bits + k_depth_bits)
+        | static_cast<uint64_t>(mesh) << k_depth_bits
+        | depth_bits;
+}
+
+auto RenderQueue::get_pass(uint64_t key) -> RenderPass
+{
+    return static_cast<RenderPass>(key >> (k_shader_bits + k_wide_indices_bits + k_mesh_bits + k_depth_bits));
+}
+
+auto RenderQueue::get_shader(uint64_t key) -> uint32_t
+{
+    return static_cast<uint32_t>(key >> (k_wide_indices_bits + k_mesh_bits + k_depth_bits))
+        & ((1u << k_shader_bits) - 1);
+}
+
+auto RenderQueue::get_wide_indices(uint64_t key) -> bool
+{
+    return ((key >> (k_mesh_bits + k_depth_bits)) & 1) != 0;
+}
+
+auto RenderQueue::get_mesh(uint64_t key) -> uint32_t
+{
+    return static_cast<uint32_t>(key >> k_depth_bits) & ((1u << k_mesh_bits) - 1);
+}
+
+auto RenderQueue::get_batch(uint64_t key) -> uint64_t
+{
+    return key >> k_depth_bits;
+}
+
+auto RenderQueue::clear() -> void
+{
+    items_.clear();
+}
+
+auto RenderQueue::push(uint64_t key, uint32_t index) -> void
+{
+    items_.push_back({.key = key, .index = index});
+}
+
+auto RenderQueue::sort() -> void
+{
+    // counts of every digit are gathered in a single pass over the items
+    std::array<std::array<size_t, k_bucket_count>, k_digit_count> counts{};
+    for (const Item& item : items_) {
+        for (int digit = 0; digit < k_digit_count; digit++) {
+            counts[digit][(item.key >> (digit * k_digit_bits)) & (k_bucket_count - 1)]++;
+        }
+    }
+
+    sorted_items_.resize(items_.size());
+    for (int digit = 0; digit < k_digit_count; digit++) {
+        auto& digit_counts = counts[digit];
+        // every item has the same digit, usually the case for the pass and shader digits
+        if (std::ranges::find(digit_counts, items_.size()) != digit_counts.end()) {
+            continue;
+        }
+        size_t offset{0};
+        for (size_t& count : digit_counts) {
+            offset += std::exchange(count, offset);
+        }
+        for (const Item& item : items_) {
+            sorted_items_[digit_counts[(item.key >> (digit * k_digit_bits)) & (k_bucket_count - 1)]++] = item;
+        }
+        std::swap(items_, sorted_items_);
+    }
+}
+
+auto RenderQueue::get_items() const -> std::span<const Item>
+{
+    return items_;
+}
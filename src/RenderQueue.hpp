@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class RenderPass : uint8_t {
+    opaque = 0,
+    transparent = 1,
+};
+
+// Draw items ordered by a packed 64 bit key, from the most significant bits:
+// pass, shader, index width, mesh and view depth. Sorting batches items by
+// shader and then mesh, opaque items of a mesh front to back and transparent
+// ones back to front. Meshes of a shader are grouped by the width of their
+// indices so each width is a single multi draw.
+class RenderQueue {
+public:
+    static constexpr int k_pass_bits = 2;
+    static constexpr int k_shader_bits = 12;
+    static constexpr int k_wide_indices_bits = 1;
+    static constexpr int k_mesh_bits = 17;
+    static constexpr int k_depth_bits = 32;
+    static_assert(k_pass_bits + k_shader_bits + k_wide_indices_bits + k_mesh_bits + k_depth_bits == 64);
+
+    struct Item {
+        uint64_t key;
+        // index of the item's data in the caller's arrays
+        uint32_t index;
+    };
+
+    // Shader and mesh are the indices of their handles and have to fit into
+    // their bits, wide_indices is set for meshes with 32 bit indices, depth is
+    // the distance in front of the camera.
+    auto static make_key(RenderPass pass, uint32_t shader, bool wide_indices, uint32_t mesh, float depth) -> uint64_t;
+    auto static get_pass(uint64_t key) -> RenderPass;
+    auto static get_shader(uint64_t key) -> uint32_t;
+    auto static get_wide_indices(uint64_t key) -> bool;
+    auto static get_mesh(uint64_t key) -> uint32_t;
+    // key without the depth, items with the same batch key are drawn together
+    auto static get_batch(uint64_t key) -> uint64_t;
+
+    auto clear() -> void;
+    auto push(uint64_t key, uint32_t index) -> void;
+    // least significant digit radix sort, items with equal keys keep their order
+    auto sort() -> void;
+    auto get_items() const -> std::span<const Item>;
+
+private:
+    static constexpr int k_digit_bits = 8;
+    static constexpr int k_digit_count = 64 / k_digit_bits;
+    static constexpr int k_bucket_count = 1 << k_digit_bits;
+
+    std::vector<Item> items_;
+    // sort scratch space, swapped with items_ after every pass
+    std::vector<Item> sorted_items_;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+
+#include "MeshRegistry.hpp"
+#include "TransformComponent.hpp"
+
+// everything the render thread draws a simulated frame from, copied out of the components
+struct RenderSnapshot {
+    struct Instance {
+        // level of detail picked by the simulation
+        MeshHandle mesh;
+        TransformComponent transform;
+    };
+
+    // transform of the player the camera follows
+    TransformComponent camera;
+    std::vector<Instance> instances;
+};
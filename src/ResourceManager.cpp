@@ -1,46 +1,184 @@
 #include "ResourceManager.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstring>
 #include <filesystem>
+#include <format>
+#include <limits>
 #include <utility>
 
 #include <SDL_error.h>
 #include <SDL_image.h>
+#include <SDL_pixels.h>
+#include <SDL_surface.h>
 
 #include "Logger.hpp"
+#include "ThreadPool.hpp"
 
-ResourceManager::ResourceManager(const std::filesystem::path& asset_directory) : asset_directory{asset_directory}, context_{nullptr}, textures_{}
+namespace
+{
+// RGBA8 pixels, rows top to bottom without padding
+struct Image {
+    uint32_t width;
+    uint32_t height;
+    std::vector<std::byte> pixels;
+};
+
+// nothing if the file can not be decoded, safe to call from worker threads
+auto decode_image(const std::filesystem::path& path) -> std::optional<Image>
+{
+    SDL_Surface* const surface = IMG_Load(path.string().c_str());
+    if (surface == nullptr) [[unlikely]] {
+        Logger::get_default()->error(std::format("Could not load texture {}: {}", path.string(), IMG_GetError()));
+        return std::nullopt;
+    }
+    SDL_Surface* const rgba_surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (rgba_surface == nullptr) [[unlikely]] {
+        Logger::get_default()->error(std::format("Could not convert texture {}: {}", path.string(), SDL_GetError()));
+        return std::nullopt;
+    }
+
+    Image image{
+        .width = static_cast<uint32_t>(rgba_surface->w),
+        .height = static_cast<uint32_t>(rgba_surface->h),
+        .pixels{},
+    };
+    const size_t row_size = image.width * 4;
+    image.pixels.resize(row_size * image.height);
+    // surface rows can be padded
+    for (uint32_t y = 0; y < image.height; y++) {
+        std::memcpy(image.pixels.data() + y * row_size,
+            static_cast<const std::byte*>(rgba_surface->pixels) + y * rgba_surface->pitch, row_size);
+    }
+    SDL_FreeSurface(rgba_surface);
+    return image;
+}
+} // namespace
+
+ResourceManager::ResourceManager(const std::filesystem::path& asset_directory) :
+    asset_directory{asset_directory}, texture_arrays_{}, texture_layers_{}, textures_{}, failed_textures_{}
 {
 }
 
-ResourceManager::ResourceManager() : asset_directory{}, context_{nullptr}, textures_{}
+ResourceManager::ResourceManager() :
+    asset_directory{}, texture_arrays_{}, texture_layers_{}, textures_{}, failed_textures_{}
 {
 }
 
 ResourceManager::~ResourceManager()
 {
-    for (auto& texture : textures_) {
-        SDL_DestroyTexture(texture.second);
-    }
+    destroy();
 }
 
-auto ResourceManager::set_context(SDL_GLContext context) -> void
+auto ResourceManager::load_textures(std::span<const std::string> texture_names) -> void
 {
-    context_ = context;
+    std::vector<std::string> names;
+    for (const std::string& texture_name : texture_names) {
+        if (!textures_.contains(texture_name) && !failed_textures_.contains(texture_name)
+            && std::ranges::find(names, texture_name) == names.end()) {
+            names.push_back(texture_name);
+        }
+    }
+    if (names.empty()) {
+        return;
+    }
+
+    // decoders are initialized up front, SDL_image would do it lazily from every worker at once
+    IMG_Init(IMG_INIT_PNG);
+    // textures are loaded in a few batches, workers only live as long as one and a single image is decoded inline
+    ThreadPool thread_pool{std::min(names.size() - 1, ThreadPool::get_default_worker_count())};
+    std::vector<std::optional<Image>> images(names.size());
+    thread_pool.parallel_for(names.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            images[i] = decode_image(asset_directory / "patches" / (names[i] + ".png"));
+        }
+    });
+    for (size_t i = 0; i < names.size(); i++) {
+        if (!images[i]) {
+            failed_textures_.insert(names[i]);
+        }
+    }
+
+    GLint max_layers{0};
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    std::vector<bool> is_uploaded(names.size(), false);
+    for (size_t first = 0; first < names.size(); first++) {
+        if (!images[first] || is_uploaded[first]) {
+            continue;
+        }
+        // every image of this size still to upload, as many as fit in an array
+        const uint32_t width = images[first]->width;
+        const uint32_t height = images[first]->height;
+        std::vector<size_t> same_size;
+        for (size_t i = first; i < names.size() && same_size.size() < static_cast<size_t>(max_layers); i++) {
+            if (images[i] && !is_uploaded[i] && images[i]->width == width && images[i]->height == height) {
+                same_size.push_back(i);
+            }
+        }
+        if (texture_arrays_.size() > std::numeric_limits<uint16_t>::max()) [[unlikely]] {
+            Logger::get_default()->error("Too many texture arrays.");
+            return;
+        }
+
+        GLuint texture_array;
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture_array);
+        const auto level_count = static_cast<GLsizei>(std::bit_width(std::max(width, height)));
+        glTextureStorage3D(texture_array, level_count, GL_RGBA8, static_cast<GLsizei>(width),
+            static_cast<GLsizei>(height), static_cast<GLsizei>(same_size.size()));
+        for (size_t layer = 0; layer < same_size.size(); layer++) {
+            const size_t i = same_size[layer];
+            glTextureSubImage3D(texture_array, 0, 0, 0, static_cast<GLint>(layer), static_cast<GLsizei>(width),
+                static_cast<GLsizei>(height), 1, GL_RGBA, GL_UNSIGNED_BYTE, images[i]->pixels.data());
+            is_uploaded[i] = true;
+            textures_.emplace(std::move(names[i]), TextureHandle{static_cast<uint32_t>(texture_layers_.size())});
+            texture_layers_.push_back({
+                .array_index = static_cast<uint16_t>(texture_arrays_.size()),
+                .layer = static_cast<uint16_t>(layer),
+            });
+        }
+        // the blocky look of the patches is kept up close, mipmaps smooth them out in the distance
+        glGenerateTextureMipmap(texture_array);
+        glTextureParameteri(texture_array, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(texture_array, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(texture_array, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(texture_array, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        texture_arrays_.push_back(texture_array);
+    }
 }
 
-auto ResourceManager::get_texture(std::string texture_name) -> SDL_Texture*
+auto ResourceManager::get_texture(const std::string& texture_name) -> std::optional<TextureHandle>
 {
-    /*
-    if (!textures_.contains(texture_name)) [[unlikely]] {
-        const std::filesystem::path texture_path = asset_directory / "patches" / (texture_name + ".png");
-        textures_[texture_name] = IMG_LoadTexture(renderer_, texture_path.string().c_str());
-        if (textures_[texture_name] == NULL) {
-            Logger::get_default()->error(std::format("Could not load texture: {}", SDL_GetError());
+    auto texture_it = textures_.find(texture_name);
+    if (texture_it == textures_.end()) [[unlikely]] {
+        load_textures({&texture_name, 1});
+        texture_it = textures_.find(texture_name);
+        if (texture_it == textures_.end()) {
+            return std::nullopt;
         }
     }
-    return textures_[texture_name];
-    */
-    (void)texture_name;
-    return nullptr;
+    return texture_it->second;
+}
+
+auto ResourceManager::get_texture_layer(TextureHandle texture) const -> TextureLayer
+{
+    return texture_layers_[texture.index];
+}
+
+auto ResourceManager::get_texture_arrays() const -> std::span<const GLuint>
+{
+    return texture_arrays_;
+}
+
+auto ResourceManager::destroy() -> void
+{
+    if (!texture_arrays_.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(texture_arrays_.size()), texture_arrays_.data());
+    }
+    texture_arrays_.clear();
+    texture_layers_.clear();
+    textures_.clear();
+    failed_textures_.clear();
 }
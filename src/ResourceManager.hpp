@@ -1,25 +1,61 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include <SDL_render.h>
+#include <GL/glew.h>
 
-class LoggingManager;
+// names a texture of a ResourceManager, handles are numbered from 0 in load order
+struct TextureHandle {
+    uint32_t index;
+
+    auto operator==(const TextureHandle&) const -> bool = default;
+};
 
 class ResourceManager {
 public:
+    // Where a texture lives, small enough to go with every instance so
+    // draws of different textures stay in one batch.
+    struct TextureLayer {
+        // index into get_texture_arrays()
+        uint16_t array_index;
+        uint16_t layer;
+    };
+
     explicit ResourceManager(const std::filesystem::path& asset_directory);
     explicit ResourceManager();
     ~ResourceManager();
 
+    ResourceManager(const ResourceManager&) = delete;
+    auto operator=(const ResourceManager&) -> ResourceManager& = delete;
+
     std::filesystem::path asset_directory;
 
-    auto set_context(SDL_GLContext context) -> void;
-    auto get_texture(std::string texture_name) -> SDL_Texture*;
+    // Loads patches/<name>.png of every name not tried yet. The images are
+    // decoded on worker threads, images of the same size become layers of
+    // the same array texture and mipmaps are generated once here. Textures
+    // that can not be read are logged once and left out. Needs a current
+    // context.
+    auto load_textures(std::span<const std::string> texture_names) -> void;
+    // loads the texture on first use, nothing if it can not be read
+    auto get_texture(const std::string& texture_name) -> std::optional<TextureHandle>;
+    auto get_texture_layer(TextureHandle texture) const -> TextureLayer;
+    // RGBA8 array textures with mipmaps and rows stored top to bottom, bind them once to consecutive texture units
+    auto get_texture_arrays() const -> std::span<const GLuint>;
+    // deletes every texture, the context they were created in has to be current
+    auto destroy() -> void;
 
 private:
-    SDL_GLContext context_;
-    std::unordered_map<std::string, SDL_Texture*> textures_;
+    std::vector<GLuint> texture_arrays_;
+    // indexed by handle
+    std::vector<TextureLayer> texture_layers_;
+    std::unordered_map<std::string, TextureHandle> textures_;
+    // names whose image could not be decoded, not tried again
+    std::unordered_set<std::string> failed_textures_;
 };
@@ -1,36 +1,67 @@
 #include "Shader.hpp"
 
+#include <algorithm>
+#include <format>
+#include <string>
+
 #include "Logger.hpp"
 
-auto shader::create_shader(std::string_view shader_string, GLenum shader_type) -> std::optional<GLuint>
+namespace
+{
+auto get_shader_type_string(GLenum shader_type) -> std::string_view
 {
-    std::string_view shader_type_string;
     switch (shader_type) {
         case GL_VERTEX_SHADER: {
-            shader_type_string = "vertex";
-            break;
+            return "vertex";
         }
         case GL_GEOMETRY_SHADER: {
-            shader_type_string = "geometry";
-            break;
+            return "geometry";
         }
         case GL_FRAGMENT_SHADER: {
-            shader_type_string = "fragment";
-            break;
+            return "fragment";
+        }
+        case GL_COMPUTE_SHADER: {
+            return "compute";
         }
         default: {
-            shader_type_string = "unknown type";
-            break;
+            return "unknown type";
         }
     }
-    const Logger* logger = Logger::get_default();
-    logger->debug(std::format("Compiling {} shader.", shader_type_string));
+}
+} // namespace
+
+auto shader::create_shader(std::string_view shader_string, GLenum shader_type) -> std::optional<GLuint>
+{
+    const GLuint shader = start_shader(shader_string, shader_type);
+    check_shader(shader, shader_type);
+    return shader;
+}
+
+auto shader::create_shader_program(const std::vector<GLuint>& shader_list, bool is_binary_retrievable)
+    -> std::optional<GLuint>
+{
+    const GLuint shader_program = start_shader_program(shader_list, is_binary_retrievable);
+    if (shader_program == 0 || !check_shader_program(shader_program, shader_list)) {
+        return std::nullopt;
+    }
+    return shader_program;
+}
+
+auto shader::start_shader(std::string_view shader_string, GLenum shader_type) -> GLuint
+{
+    Logger::get_default()->debug(std::format("Compiling {} shader.", get_shader_type_string(shader_type)));
     GLuint shader = glCreateShader(shader_type);
 
     const char* shader_source = shader_string.data();
-    glShaderSource(shader, 1, &shader_source, NULL);
+    const auto shader_length = static_cast<GLint>(shader_string.size());
+    glShaderSource(shader, 1, &shader_source, &shader_length);
     glCompileShader(shader);
+    return shader;
+}
 
+auto shader::check_shader(GLuint shader, GLenum shader_type) -> bool
+{
+    const Logger* logger = Logger::get_default();
     GLint compile_status;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &compile_status);
     GLint info_log_length;
@@ -39,16 +70,16 @@ auto shader::create_shader(std::string_view shader_string, GLenum shader_type) -
     glGetShaderInfoLog(shader, info_log_length, NULL, info_log.data());
 
     if (compile_status == GL_FALSE) {
-        logger->error(std::format("Compile failure in {} shader: {}", shader_type_string, info_log));
+        logger->error(
+            std::format("Compile failure in {} shader: {}", get_shader_type_string(shader_type), info_log));
     }
     if (info_log_length > 0) {
         logger->debug(info_log);
     }
-
-    return shader;
+    return compile_status != GL_FALSE;
 }
 
-auto shader::create_shader_program(const std::vector<GLuint>& shader_list) -> std::optional<GLuint>
+auto shader::start_shader_program(const std::vector<GLuint>& shader_list, bool is_binary_retrievable) -> GLuint
 {
     const Logger* logger = Logger::get_default();
     logger->debug("Compiling shader program.");
@@ -56,13 +87,21 @@ auto shader::create_shader_program(const std::vector<GLuint>& shader_list) -> st
     GLuint shader_program = glCreateProgram();
     if (shader_program == 0) {
         logger->error("Error creating shader program.");
-        return std::nullopt;
+        return 0;
     }
 
     std::for_each(shader_list.begin(), shader_list.end(),
         [shader_program](GLuint shader) { glAttachShader(shader_program, shader); });
+    if (is_binary_retrievable) {
+        glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(shader_program);
+    return shader_program;
+}
 
+auto shader::check_shader_program(GLuint shader_program, const std::vector<GLuint>& shader_list) -> bool
+{
+    const Logger* logger = Logger::get_default();
     GLint program_status;
     glGetProgramiv(shader_program, GL_LINK_STATUS, &program_status);
     GLint info_log_length;
@@ -72,7 +111,7 @@ auto shader::create_shader_program(const std::vector<GLuint>& shader_list) -> st
 
     if (program_status == GL_FALSE) {
         logger->error(std::format("Shader linker error: {}", info_log));
-        return std::nullopt;
+        return false;
     }
     if (info_log_length > 0) {
         logger->debug(info_log);
@@ -80,6 +119,5 @@ auto shader::create_shader_program(const std::vector<GLuint>& shader_list) -> st
 
     std::for_each(shader_list.begin(), shader_list.end(),
         [shader_program](GLuint shader) { glDetachShader(shader_program, shader); });
-
-    return shader_program;
+    return true;
 }
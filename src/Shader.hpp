@@ -2,11 +2,26 @@
 
 #include <filesystem>
 #include <optional>
+#include <string_view>
+#include <vector>
 
 #include <gl/glew.h>
 
 namespace shader
 {
     auto create_shader(std::string_view shader_string, GLenum shader_type) -> std::optional<GLuint>;
-    auto create_shader_program(const std::vector<GLuint>& shader_list) -> std::optional<GLuint>;
+    // the binary of a retrievable program can be read back with glGetProgramBinary
+    auto create_shader_program(const std::vector<GLuint>& shader_list, bool is_binary_retrievable = false)
+        -> std::optional<GLuint>;
+
+    // The functions above split so the driver can compile in the background.
+    // Starting does not query anything, checking waits for the result unless
+    // GL_COMPLETION_STATUS_KHR reported it done.
+    auto start_shader(std::string_view shader_string, GLenum shader_type) -> GLuint;
+    // logs the compile log, false if the shader did not compile
+    auto check_shader(GLuint shader, GLenum shader_type) -> bool;
+    // 0 if the program could not be created
+    auto start_shader_program(const std::vector<GLuint>& shader_list, bool is_binary_retrievable = false) -> GLuint;
+    // logs the link log and detaches the shaders, false if the program did not link
+    auto check_shader_program(GLuint shader_program, const std::vector<GLuint>& shader_list) -> bool;
 };
@@ -0,0 +1,241 @@
+#include "ShaderLibrary.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include "Logger.hpp"
+
+namespace
+{
+constexpr std::string_view k_include_directive = "#include";
+constexpr std::string_view k_version_directive = "#version";
+
+// time the file was last written, nothing if it does not exist
+auto get_write_time(const std::filesystem::path& path) -> std::optional<std::filesystem::file_time_type>
+{
+    std::error_code error;
+    const auto write_time = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+    return write_time;
+}
+
+// #line for the line after the directive, source string numbers are indices into Preprocessed::files
+auto append_line_directive(std::string& source, size_t next_line, size_t file_index) -> void
+{
+    source.append("#line ").append(std::to_string(next_line)).append(" ").append(std::to_string(file_index));
+    source.push_back('\n');
+}
+} // namespace
+
+ShaderLibrary::ShaderLibrary(ProgramCache& program_cache, std::filesystem::path shader_directory) :
+    program_cache_{program_cache}, shader_directory_{std::move(shader_directory)}, entries_{}, handles_{},
+    next_reload_{}
+{
+}
+
+auto ShaderLibrary::load(std::span<const Stage> stages, std::span<const Define> defines) -> std::optional<ShaderHandle>
+{
+    std::string key;
+    for (const Stage& stage : stages) {
+        key.append(std::to_string(stage.type)).append(" ").append(stage.file_name).push_back('\n');
+    }
+    for (const Define& define : defines) {
+        key.append(define.name).append(" ").append(define.value).push_back('\n');
+    }
+    const auto handle_it = handles_.find(key);
+    if (handle_it != handles_.end()) [[likely]] {
+        return handle_it->second;
+    }
+
+    Entry entry{
+        .stages{stages.begin(), stages.end()},
+        .defines{defines.begin(), defines.end()},
+        .files{},
+        .program{},
+        .pending_program{},
+    };
+    if (!submit(entry)) [[unlikely]] {
+        return std::nullopt;
+    }
+    const ShaderHandle handle{static_cast<uint32_t>(entries_.size())};
+    entries_.push_back(std::move(entry));
+    handles_.emplace(std::move(key), handle);
+    return handle;
+}
+
+auto ShaderLibrary::poll(ShaderHandle shader) -> ProgramStatus
+{
+    Entry& entry = entries_[shader.index];
+    if (entry.pending_program) [[unlikely]] {
+        const ProgramStatus status = program_cache_.poll_program(*entry.pending_program);
+        if (status == ProgramStatus::ready) {
+            if (entry.program) {
+                program_cache_.release_program(*entry.program);
+            }
+            entry.program = entry.pending_program;
+            entry.pending_program.reset();
+        }
+        else if (status == ProgramStatus::failed) {
+            if (entry.program) {
+                Logger::get_default()->warning(
+                    std::format("Keeping the previous build of shader {}.", entry.stages.front().file_name));
+            }
+            entry.pending_program.reset();
+        }
+    }
+    if (entry.program) [[likely]] {
+        return ProgramStatus::ready;
+    }
+    return entry.pending_program ? ProgramStatus::compiling : ProgramStatus::failed;
+}
+
+auto ShaderLibrary::get_program(ShaderHandle shader) const -> std::optional<GLuint>
+{
+    const Entry& entry = entries_[shader.index];
+    if (!entry.program) {
+        return std::nullopt;
+    }
+    return program_cache_.get_program(*entry.program);
+}
+
+auto ShaderLibrary::update() -> void
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next_reload_) [[likely]] {
+        return;
+    }
+    next_reload_ = now + k_reload_interval;
+    reload_changed();
+}
+
+auto ShaderLibrary::reload_changed() -> void
+{
+    for (Entry& entry : entries_) {
+        // files that vanished are usually being saved, they are checked again next time
+        const bool is_changed = std::ranges::any_of(entry.files, [](const auto& file) {
+            const auto write_time = get_write_time(file.first);
+            return write_time && *write_time != file.second;
+        });
+        if (is_changed) {
+            Logger::get_default()->info(std::format("Reloading shader {}.", entry.stages.front().file_name));
+            submit(entry);
+        }
+    }
+}
+
+auto ShaderLibrary::preprocess(std::string_view file_name, std::span<const Define> defines) const
+    -> std::optional<Preprocessed>
+{
+    Preprocessed preprocessed;
+    if (!append_file(shader_directory_ / file_name, 0, defines, preprocessed)) {
+        return std::nullopt;
+    }
+    return preprocessed;
+}
+
+auto ShaderLibrary::submit(Entry& entry) -> bool
+{
+    std::vector<Preprocessed> preprocessed_stages;
+    for (const Stage& stage : entry.stages) {
+        auto preprocessed = preprocess(stage.file_name, entry.defines);
+        if (!preprocessed) [[unlikely]] {
+            return false;
+        }
+        preprocessed_stages.push_back(std::move(*preprocessed));
+    }
+
+    std::vector<ProgramCache::ShaderSource> shader_sources;
+    entry.files.clear();
+    for (size_t i = 0; i < entry.stages.size(); i++) {
+        shader_sources.push_back({.type = entry.stages[i].type, .source = preprocessed_stages[i].source});
+        for (const std::filesystem::path& file : preprocessed_stages[i].files) {
+            const auto write_time = get_write_time(file);
+            const bool is_listed
+                = std::ranges::any_of(entry.files, [&](const auto& listed) { return listed.first == file; });
+            if (write_time && !is_listed) {
+                entry.files.emplace_back(file, *write_time);
+            }
+        }
+    }
+    // a newer build replaces one that is still compiling
+    if (entry.pending_program) {
+        program_cache_.release_program(*entry.pending_program);
+    }
+    entry.pending_program = program_cache_.submit_program(shader_sources);
+    return true;
+}
+
+auto ShaderLibrary::append_file(const std::filesystem::path& path, int depth, std::span<const Define> defines,
+    Preprocessed& preprocessed) const -> bool
+{
+    if (depth > k_max_include_depth) [[unlikely]] {
+        Logger::get_default()->warning(std::format("Includes nest deeper than {} at {}.", k_max_include_depth,
+            path.string()));
+        return false;
+    }
+    if (std::ranges::find(preprocessed.files, path) != preprocessed.files.end()) {
+        return true;
+    }
+    std::ifstream file{path, std::ios_base::binary};
+    if (!file) [[unlikely]] {
+        Logger::get_default()->warning(std::format("Could not open shader file {}.", path.string()));
+        return false;
+    }
+    const std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    const size_t file_index = preprocessed.files.size();
+    preprocessed.files.push_back(path);
+    std::string& source = preprocessed.source;
+
+    // defines go into the top file right after #version, which has to come first, or at its top without one
+    bool has_defines = depth > 0;
+    const auto append_defines = [&](size_t next_line) {
+        for (const Define& define : defines) {
+            source.append("#define ").append(define.name).append(" ").append(define.value).push_back('\n');
+        }
+        append_line_directive(source, next_line, file_index);
+        has_defines = true;
+    };
+    if (depth > 0) {
+        append_line_directive(source, 1, file_index);
+    }
+    else if (contents.find(k_version_directive) == std::string::npos) {
+        append_defines(1);
+    }
+
+    size_t line_number{0};
+    for (size_t line_begin = 0; line_begin < contents.size();) {
+        const size_t line_end = std::min(contents.find('\n', line_begin), contents.size());
+        const std::string_view line = std::string_view{contents}.substr(line_begin, line_end - line_begin);
+        line_begin = line_end + 1;
+        line_number++;
+        const std::string_view directive = line.substr(std::min(line.find_first_not_of(" \t"), line.size()));
+
+        if (directive.starts_with(k_include_directive)) {
+            const size_t name_begin = directive.find('"');
+            const size_t name_end = name_begin == std::string_view::npos
+                ? std::string_view::npos
+                : directive.find('"', name_begin + 1);
+            if (name_end == std::string_view::npos) [[unlikely]] {
+                Logger::get_default()->warning(
+                    std::format("Malformed include in {} on line {}.", path.string(), line_number));
+                return false;
+            }
+            const std::string_view include_name = directive.substr(name_begin + 1, name_end - name_begin - 1);
+            if (!append_file(shader_directory_ / include_name, depth + 1, defines, preprocessed)) {
+                return false;
+            }
+            append_line_directive(source, line_number + 1, file_index);
+            continue;
+        }
+        source.append(line).push_back('\n');
+        if (!has_defines && directive.starts_with(k_version_directive)) {
+            append_defines(line_number + 1);
+        }
+    }
+    return true;
+}
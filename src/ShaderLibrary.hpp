@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ProgramCache.hpp"
+
+// names a program of a ShaderLibrary, handles are numbered from 0 in load order
+struct ShaderHandle {
+    uint32_t index;
+
+    auto operator==(const ShaderHandle&) const -> bool = default;
+};
+
+// Builds programs from GLSL files in the shader directory. A file pulls in
+// others with #include "name", named relative to the shader directory, and
+// every program is a permutation of its files for a set of defines inserted
+// after the #version line. Each permutation is built once.
+//
+// Programs are hot reloaded: once a file a program was built from changes
+// it is built again in the background. The previous build is used until the
+// new one is ready, and kept if the new one does not compile.
+class ShaderLibrary {
+public:
+    // file of a stage of a program
+    struct Stage {
+        GLenum type;
+        std::string file_name;
+    };
+
+    // inserted as #define name value
+    struct Define {
+        std::string name;
+        std::string value;
+    };
+
+    // source with every include resolved and the defines inserted
+    struct Preprocessed {
+        std::string source;
+        // the file and everything it includes, in the order they were read
+        std::vector<std::filesystem::path> files;
+    };
+
+    // programs are built through program_cache, which has to outlive the library
+    ShaderLibrary(ProgramCache& program_cache, std::filesystem::path shader_directory);
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    auto operator=(const ShaderLibrary&) -> ShaderLibrary& = delete;
+
+    // Submits the permutation on first use, nothing if a file can not be
+    // read. Needs a current context.
+    auto load(std::span<const Stage> stages, std::span<const Define> defines = {}) -> std::optional<ShaderHandle>;
+    // Ready as soon as a build is, compiling until then and failed if the
+    // first build failed. Swaps in finished rebuilds.
+    auto poll(ShaderHandle shader) -> ProgramStatus;
+    // latest ready build, it changes after a reload
+    auto get_program(ShaderHandle shader) const -> std::optional<GLuint>;
+    // reloads changed programs at most every k_reload_interval, meant to be called every frame
+    auto update() -> void;
+    // rebuilds every program whose files changed since it was last built
+    auto reload_changed() -> void;
+
+    // Reads the file and its includes, every file is included at most once.
+    // Nothing if a file can not be read or the includes nest too deep.
+    auto preprocess(std::string_view file_name, std::span<const Define> defines = {}) const
+        -> std::optional<Preprocessed>;
+
+private:
+    static constexpr auto k_reload_interval = std::chrono::milliseconds{500};
+    static constexpr int k_max_include_depth = 16;
+
+    struct Entry {
+        std::vector<Stage> stages;
+        std::vector<Define> defines;
+        // every file the last submitted build read and its write time then
+        std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> files;
+        std::optional<ProgramHandle> program;
+        // build submitted after program, replaces it once ready
+        std::optional<ProgramHandle> pending_program;
+    };
+
+    ProgramCache& program_cache_;
+    std::filesystem::path shader_directory_;
+    // indexed by handle
+    std::vector<Entry> entries_;
+    // keyed by the stage files and defines of the permutation
+    std::unordered_map<std::string, ShaderHandle> handles_;
+    std::chrono::steady_clock::time_point next_reload_;
+
+    // preprocesses the stages and submits them as the entry's pending program, false if a file can not be read
+    auto submit(Entry& entry) -> bool;
+    // appends the file to preprocessed, false if it or an include can not be read
+    auto append_file(const std::filesystem::path& path, int depth, std::span<const Define> defines,
+        Preprocessed& preprocessed) const -> bool;
+};
@@ -0,0 +1,205 @@
+#include "SpatialHashGrid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include "ThreadPool.hpp"
+
+namespace
+{
+// hash buckets handed to a thread at a time, most of them hold no or a single cell
+constexpr size_t k_buckets_per_range = 256;
+
+auto is_pair_before(const BroadphasePair& lhs, const BroadphasePair& rhs) -> bool
+{
+    return lhs.entity_a != rhs.entity_a ? lhs.entity_a < rhs.entity_a : lhs.entity_b < rhs.entity_b;
+}
+} // namespace
+
+SpatialHashGrid::SpatialHashGrid(float cell_size) :
+    inverse_cell_size_{1.0f / cell_size}, proxies_{}, cells_{}, range_pairs_{}
+{
+    assert(cell_size > 0 && "Cell size must be positive");
+}
+
+auto SpatialHashGrid::update(int entity_id, const Aabb& bounds) -> void
+{
+    if (static_cast<size_t>(entity_id) >= proxies_.size()) {
+        proxies_.resize(entity_id + 1, {.bounds = {}, .cells = {}, .in_use = false});
+    }
+    Proxy& proxy = proxies_[entity_id];
+    const CellRange range = get_cell_range(bounds);
+    if (!proxy.in_use) {
+        add_to_cells(entity_id, range);
+        proxy = {.bounds = bounds, .cells = range, .in_use = true};
+        return;
+    }
+
+    proxy.bounds = bounds;
+    // most frames a body stays inside the same cells
+    if (proxy.cells == range) [[likely]] {
+        return;
+    }
+    remove_from_cells(entity_id, proxy.cells);
+    add_to_cells(entity_id, range);
+    proxy.cells = range;
+}
+
+auto SpatialHashGrid::remove(int entity_id) -> void
+{
+    if (!contains(entity_id)) [[unlikely]] {
+        return;
+    }
+    remove_from_cells(entity_id, proxies_[entity_id].cells);
+    proxies_[entity_id].in_use = false;
+}
+
+auto SpatialHashGrid::contains(int entity_id) const -> bool
+{
+    return entity_id >= 0 && static_cast<size_t>(entity_id) < proxies_.size() && proxies_[entity_id].in_use;
+}
+
+auto SpatialHashGrid::get_bounds(int entity_id) const -> const Aabb&
+{
+    assert(contains(entity_id) && "Entity is not in the grid");
+    return proxies_[entity_id].bounds;
+}
+
+auto SpatialHashGrid::find_pairs(std::vector<BroadphasePair>& pairs) const -> void
+{
+    pairs.clear();
+    for (const auto& [key, cell] : cells_) {
+        append_cell_pairs(cell, pairs);
+    }
+    // cell iteration order is unspecified, sort to keep the simulation deterministic
+    std::sort(pairs.begin(), pairs.end(), is_pair_before);
+}
+
+auto SpatialHashGrid::find_pairs(std::vector<BroadphasePair>& pairs, ThreadPool& thread_pool) -> void
+{
+    // buckets can be walked independently, every range of them collects its own pairs
+    const size_t bucket_count = cells_.bucket_count();
+    const size_t range_count = (bucket_count + k_buckets_per_range - 1) / k_buckets_per_range;
+    if (range_pairs_.size() < range_count) {
+        range_pairs_.resize(range_count);
+    }
+    thread_pool.parallel_for(bucket_count, k_buckets_per_range, [this](size_t begin, size_t end) {
+        std::vector<BroadphasePair>& range_pairs = range_pairs_[begin / k_buckets_per_range];
+        range_pairs.clear();
+        for (size_t bucket = begin; bucket < end; bucket++) {
+            for (auto cell_it = cells_.cbegin(bucket); cell_it != cells_.cend(bucket); ++cell_it) {
+                append_cell_pairs(cell_it->second, range_pairs);
+            }
+        }
+    });
+
+    pairs.clear();
+    for (size_t i = 0; i < range_count; i++) {
+        pairs.insert(pairs.end(), range_pairs_[i].begin(), range_pairs_[i].end());
+    }
+    std::sort(pairs.begin(), pairs.end(), is_pair_before);
+}
+
+auto SpatialHashGrid::query(const Aabb& bounds, std::vector<int>& result) const -> void
+{
+    const size_t first_result = result.size();
+    const CellRange range = get_cell_range(bounds);
+    for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        for (int32_t y = range.min_y; y <= range.max_y; y++) {
+            for (int32_t z = range.min_z; z <= range.max_z; z++) {
+                const auto cell_it = cells_.find(get_cell_key(x, y, z));
+                if (cell_it == cells_.end()) {
+                    continue;
+                }
+                for (const int entity_id : cell_it->second.entities) {
+                    if (proxies_[entity_id].bounds.overlaps(bounds)) {
+                        result.push_back(entity_id);
+                    }
+                }
+            }
+        }
+    }
+    std::sort(result.begin() + first_result, result.end());
+    result.erase(std::unique(result.begin() + first_result, result.end()), result.end());
+}
+
+auto SpatialHashGrid::get_cell_range(const Aabb& bounds) const -> CellRange
+{
+    return {
+        .min_x = static_cast<int32_t>(std::floor(bounds.min.x * inverse_cell_size_)),
+        .min_y = static_cast<int32_t>(std::floor(bounds.min.y * inverse_cell_size_)),
+        .min_z = static_cast<int32_t>(std::floor(bounds.min.z * inverse_cell_size_)),
+        .max_x = static_cast<int32_t>(std::floor(bounds.max.x * inverse_cell_size_)),
+        .max_y = static_cast<int32_t>(std::floor(bounds.max.y * inverse_cell_size_)),
+        .max_z = static_cast<int32_t>(std::floor(bounds.max.z * inverse_cell_size_)),
+    };
+}
+
+auto SpatialHashGrid::get_cell_key(int32_t x, int32_t y, int32_t z) -> uint64_t
+{
+    // 21 bits per axis, coordinates wrap around outside of +-2^20 cells
+    constexpr uint64_t mask = (1 << 21) - 1;
+    return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21)
+        | ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+auto SpatialHashGrid::append_cell_pairs(const Cell& cell, std::vector<BroadphasePair>& pairs) const -> void
+{
+    const std::vector<int>& entities = cell.entities;
+    for (size_t i = 0; i < entities.size(); i++) {
+        const Proxy& a = proxies_[entities[i]];
+        for (size_t j = i + 1; j < entities.size(); j++) {
+            const Proxy& b = proxies_[entities[j]];
+            if (!a.bounds.overlaps(b.bounds)) {
+                continue;
+            }
+            // entities sharing several cells are only reported by the
+            // first cell of the overlap of their ranges
+            if (cell.x != std::max(a.cells.min_x, b.cells.min_x) || cell.y != std::max(a.cells.min_y, b.cells.min_y)
+                || cell.z != std::max(a.cells.min_z, b.cells.min_z)) {
+                continue;
+            }
+            pairs.push_back({std::min(entities[i], entities[j]), std::max(entities[i], entities[j])});
+        }
+    }
+}
+
+auto SpatialHashGrid::add_to_cells(int entity_id, const CellRange& range) -> void
+{
+    for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        for (int32_t y = range.min_y; y <= range.max_y; y++) {
+            for (int32_t z = range.min_z; z <= range.max_z; z++) {
+                Cell& cell = cells_[get_cell_key(x, y, z)];
+                cell.x = x;
+                cell.y = y;
+                cell.z = z;
+                cell.entities.push_back(entity_id);
+            }
+        }
+    }
+}
+
+auto SpatialHashGrid::remove_from_cells(int entity_id, const CellRange& range) -> void
+{
+    for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        for (int32_t y = range.min_y; y <= range.max_y; y++) {
+            for (int32_t z = range.min_z; z <= range.max_z; z++) {
+                const auto cell_it = cells_.find(get_cell_key(x, y, z));
+                if (cell_it == cells_.end()) [[unlikely]] {
+                    continue;
+                }
+                std::vector<int>& entities = cell_it->second.entities;
+                const auto entity_it = std::find(entities.begin(), entities.end(), entity_id);
+                if (entity_it != entities.end()) {
+                    *entity_it = entities.back();
+                    entities.pop_back();
+                }
+                if (entities.empty()) {
+                    cells_.erase(cell_it);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Aabb.hpp"
+
+class ThreadPool;
+
+// pair of entities whose bounds overlap, entity_a is always the smaller id
+struct BroadphasePair {
+    int entity_a;
+    int entity_b;
+
+    auto operator==(const BroadphasePair&) const -> bool = default;
+};
+
+// Uniform grid hashed into a sparse map of cells. Every entity is bucketed into
+// all cells its bounds touch and only changes buckets when it crosses a cell
+// boundary, so moving bodies cost little to keep up to date.
+class SpatialHashGrid {
+public:
+    explicit SpatialHashGrid(float cell_size);
+
+    // inserts the entity if it is not in the grid yet
+    auto update(int entity_id, const Aabb& bounds) -> void;
+    auto remove(int entity_id) -> void;
+    auto contains(int entity_id) const -> bool;
+    auto get_bounds(int entity_id) const -> const Aabb&;
+
+    // Replaces pairs with every pair of overlapping entities, sorted by
+    // entity ids. Every pair is reported once even if the entities share
+    // several cells.
+    auto find_pairs(std::vector<BroadphasePair>& pairs) const -> void;
+    // same as above with the cells split between the threads of thread_pool
+    auto find_pairs(std::vector<BroadphasePair>& pairs, ThreadPool& thread_pool) -> void;
+    // appends entities whose bounds overlap given bounds to result, without duplicates
+    auto query(const Aabb& bounds, std::vector<int>& result) const -> void;
+
+private:
+    // inclusive range of cell coordinates covered by a box
+    struct CellRange {
+        int32_t min_x;
+        int32_t min_y;
+        int32_t min_z;
+        int32_t max_x;
+        int32_t max_y;
+        int32_t max_z;
+
+        auto operator==(const CellRange&) const -> bool = default;
+    };
+
+    struct Cell {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        std::vector<int> entities;
+    };
+
+    struct Proxy {
+        Aabb bounds;
+        CellRange cells;
+        bool in_use;
+    };
+
+    // integer hash with good spread for the packed cell coordinates
+    struct CellKeyHash {
+        auto operator()(uint64_t key) const -> size_t
+        {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<size_t>(key);
+        }
+    };
+
+    float inverse_cell_size_;
+    // indexed by entity id
+    std::vector<Proxy> proxies_;
+    std::unordered_map<uint64_t, Cell, CellKeyHash> cells_;
+    // pairs found by every bucket range of a parallel search, kept to reuse their memory
+    std::vector<std::vector<BroadphasePair>> range_pairs_;
+
+    auto get_cell_range(const Aabb& bounds) const -> CellRange;
+    auto static get_cell_key(int32_t x, int32_t y, int32_t z) -> uint64_t;
+    auto add_to_cells(int entity_id, const CellRange& range) -> void;
+    auto remove_from_cells(int entity_id, const CellRange& range) -> void;
+    auto append_cell_pairs(const Cell& cell, std::vector<BroadphasePair>& pairs) const -> void;
+};
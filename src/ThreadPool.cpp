@@ -0,0 +1,103 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t worker_count) :
+    workers_{}, mutex_{}, work_available_{}, work_done_{}, function_{nullptr}, count_{0}, grain_size_{1},
+    next_begin_{0}, generation_{0}, running_workers_{0}, is_stopping_{false}
+{
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; i++) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock{mutex_};
+        is_stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+auto ThreadPool::get_default_worker_count() -> size_t
+{
+    const unsigned int hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+auto ThreadPool::get_thread_count() const -> size_t
+{
+    return workers_.size() + 1;
+}
+
+auto ThreadPool::parallel_for(size_t count, size_t grain_size, const std::function<void(size_t, size_t)>& function)
+    -> void
+{
+    if (count == 0) {
+        return;
+    }
+    grain_size = std::max<size_t>(grain_size, 1);
+    // not worth waking the workers for a single range
+    if (workers_.empty() || count <= grain_size) {
+        for (size_t begin = 0; begin < count; begin += grain_size) {
+            function(begin, std::min(begin + grain_size, count));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock{mutex_};
+        function_ = &function;
+        count_ = count;
+        grain_size_ = grain_size;
+        next_begin_.store(0);
+        running_workers_ = workers_.size();
+        generation_++;
+    }
+    work_available_.notify_all();
+
+    run_ranges();
+
+    std::unique_lock lock{mutex_};
+    work_done_.wait(lock, [this] { return running_workers_ == 0; });
+    function_ = nullptr;
+}
+
+auto ThreadPool::worker_loop() -> void
+{
+    uint64_t seen_generation{0};
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            work_available_.wait(lock, [&] { return is_stopping_ || generation_ != seen_generation; });
+            if (is_stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        run_ranges();
+
+        {
+            std::lock_guard lock{mutex_};
+            running_workers_--;
+        }
+        work_done_.notify_one();
+    }
+}
+
+auto ThreadPool::run_ranges() -> void
+{
+    while (true) {
+        const size_t begin = next_begin_.fetch_add(grain_size_);
+        if (begin >= count_) {
+            return;
+        }
+        (*function_)(begin, std::min(begin + grain_size_, count_));
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data parallel loops. The calling thread
+// works on the loop as well, so a pool without workers runs everything inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t worker_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+    // one less than the hardware threads, the calling thread makes up the rest
+    auto static get_default_worker_count() -> size_t;
+    // workers plus the calling thread
+    auto get_thread_count() const -> size_t;
+
+    // Calls function(begin, end) for consecutive ranges of at most grain_size
+    // covering [0, count) and returns once all of them are done. Ranges run
+    // in no particular order on any thread, so function must not depend on
+    // the order.
+    auto parallel_for(size_t count, size_t grain_size, const std::function<void(size_t, size_t)>& function) -> void;
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable work_done_;
+    // current loop, only changed while no worker is running
+    const std::function<void(size_t, size_t)>* function_;
+    size_t count_;
+    size_t grain_size_;
+    std::atomic<size_t> next_begin_;
+    // incremented for every loop so workers can tell a new loop from a spurious wakeup
+    uint64_t generation_;
+    size_t running_workers_;
+    bool is_stopping_;
+
+    auto worker_loop() -> void;
+    auto run_ranges() -> void;
+};
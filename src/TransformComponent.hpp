@@ -1,6 +1,5 @@
 #pragma once
 
-#include "Matrix4x4.hpp"
 #include "Vector3.hpp"
 #include "Quaternion.hpp"
 
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands values from one producer thread to one consumer thread without
+// locks. Each owns a slot of its own and they trade it for the shared third
+// slot, so neither ever waits on the other. The consumer always gets the
+// latest published value, values published in between are dropped.
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : buffers_{}, write_index_{0}, shared_state_{1}, read_index_{2}
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    auto operator=(const TripleBuffer&) -> TripleBuffer& = delete;
+
+    // producer only, holds whatever was published in it before, so vectors keep their capacity
+    auto get_write_buffer() -> T&
+    {
+        return buffers_[write_index_];
+    }
+
+    // producer only, makes the write buffer the latest value and continues in the shared slot
+    auto publish() -> void
+    {
+        const uint8_t previous = shared_state_.exchange(write_index_ | k_is_fresh, std::memory_order_acq_rel);
+        write_index_ = previous & k_index_mask;
+    }
+
+    // consumer only, switches to the latest value, false if nothing was published since the last switch
+    auto update() -> bool
+    {
+        // only the consumer clears k_is_fresh, so it is still set when the slots are traded
+        if ((shared_state_.load(std::memory_order_relaxed) & k_is_fresh) == 0) {
+            return false;
+        }
+        const uint8_t previous = shared_state_.exchange(read_index_, std::memory_order_acq_rel);
+        read_index_ = previous & k_index_mask;
+        return true;
+    }
+
+    // consumer only, value-initialized until the first update
+    auto get_read_buffer() const -> const T&
+    {
+        return buffers_[read_index_];
+    }
+
+private:
+    static constexpr uint8_t k_index_mask = 0b11;
+    // set in shared_state_ while the shared slot holds a value the consumer has not seen
+    static constexpr uint8_t k_is_fresh = 0b100;
+
+    std::array<T, 3> buffers_;
+    uint8_t write_index_;
+    // index of the shared slot and k_is_fresh
+    std::atomic<uint8_t> shared_state_;
+    uint8_t read_index_;
+};
@@ -33,6 +33,16 @@ public:
         return x * rhs.x + y * rhs.y + z * rhs.z;
     }
 
+    auto cross(const Vector3<T>& rhs) const -> Vector3<T>
+    {
+        return {y * rhs.z - z * rhs.y, z * rhs.x - x * rhs.z, x * rhs.y - y * rhs.x};
+    }
+
+    auto length() const -> T
+    {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+
     auto operator-() const -> Vector3<T>
     {
         return {-x, -y, -z};
@@ -109,7 +119,7 @@ public:
     }
 
     // element-wise multiplication
-    auto element_wise(const Vector3& rhs) -> Vector3<T>
+    auto element_wise(const Vector3& rhs) const -> Vector3<T>
     {
         return {x * rhs.x, y * rhs.y, z * rhs.z};
     }
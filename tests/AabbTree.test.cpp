@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h> // IWYU pragma: keep
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Aabb.hpp"
+#include "AabbTree.hpp"
+#include "Frustum.hpp"
+#include "Matrix4x4.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+auto box_at(const Vector3f& center, float half_size = 0.5f) -> Aabb
+{
+    return {center - half_size, center + half_size};
+}
+
+auto random_boxes(int count) -> std::vector<Aabb>
+{
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<float> position{-100.0f, 100.0f};
+    std::uniform_real_distribution<float> size{0.1f, 3.0f};
+    std::vector<Aabb> boxes;
+    for (int i = 0; i < count; i++) {
+        boxes.push_back(box_at({position(generator), position(generator), position(generator)}, size(generator)));
+    }
+    return boxes;
+}
+} // namespace
+
+TEST(AabbTreeTest, StaysBalanced)
+{
+    AabbTree tree;
+    const std::vector<Aabb> boxes = random_boxes(1000);
+    for (int i = 0; i < 1000; i++) {
+        tree.update(i, boxes[i]);
+    }
+    EXPECT_TRUE(tree.validate());
+    // a balanced binary tree of 1000 leaves
+    EXPECT_LE(tree.get_height(), 20);
+
+    for (int i = 0; i < 1000; i += 2) {
+        tree.remove(i);
+    }
+    EXPECT_TRUE(tree.validate());
+    EXPECT_FALSE(tree.contains(0));
+    EXPECT_TRUE(tree.contains(1));
+}
+
+TEST(AabbTreeTest, SmallMovesKeepFatBounds)
+{
+    AabbTree tree;
+    tree.update(0, box_at({0.0f, 0.0f, 0.0f}));
+    EXPECT_FALSE(tree.update(0, box_at({AabbTree::k_fat_margin / 2, 0.0f, 0.0f})));
+    EXPECT_TRUE(tree.update(0, box_at({5.0f, 0.0f, 0.0f})));
+    EXPECT_TRUE(tree.get_fat_bounds(0).contains(box_at({5.0f, 0.0f, 0.0f})));
+}
+
+TEST(AabbTreeTest, QueryMatchesBruteForce)
+{
+    AabbTree tree;
+    const std::vector<Aabb> boxes = random_boxes(500);
+    for (int i = 0; i < 500; i++) {
+        tree.update(i, boxes[i]);
+    }
+    const Aabb query_bounds = box_at({10.0f, -5.0f, 20.0f}, 30.0f);
+
+    std::vector<int> result;
+    tree.query(query_bounds, [&result](int entity_id) {
+        result.push_back(entity_id);
+        return true;
+    });
+    std::sort(result.begin(), result.end());
+
+    std::vector<int> expected;
+    for (int i = 0; i < 500; i++) {
+        if (tree.get_fat_bounds(i).overlaps(query_bounds)) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_EQ(result, expected);
+}
+
+TEST(AabbTreeTest, RaycastFindsClosest)
+{
+    AabbTree tree;
+    tree.update(0, box_at({0.0f, 0.0f, -10.0f}));
+    tree.update(1, box_at({0.0f, 0.0f, -5.0f}));
+    tree.update(2, box_at({0.0f, 3.0f, -2.0f}));
+
+    int closest = -1;
+    tree.raycast({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, 100.0f, [&closest](int entity_id, float distance) {
+        closest = entity_id;
+        return distance;
+    });
+    EXPECT_EQ(closest, 1);
+
+    int hit_count = 0;
+    tree.raycast({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, 3.0f, [&hit_count](int, float) {
+        hit_count++;
+        return 3.0f;
+    });
+    EXPECT_EQ(hit_count, 0);
+}
+
+TEST(AabbTreeTest, RayPacketMatchesSingleRays)
+{
+    AabbTree tree;
+    const std::vector<Aabb> boxes = random_boxes(500);
+    for (int i = 0; i < static_cast<int>(boxes.size()); i++) {
+        tree.update(i, boxes[i]);
+    }
+
+    std::mt19937 generator{7};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    RayPacket packet;
+    std::array<Vector3f, RayPacket::k_size> origins;
+    std::array<Vector3f, RayPacket::k_size> directions;
+    for (size_t lane = 0; lane < RayPacket::k_size; lane++) {
+        origins[lane] = Vector3f{coordinate(generator), coordinate(generator), coordinate(generator)} * 50.0f;
+        // aimed at a box so every lane hits something
+        const Vector3f direction = boxes[lane * 100].center() - origins[lane];
+        directions[lane] = direction / direction.length();
+        packet.origin_x[lane] = origins[lane].x;
+        packet.origin_y[lane] = origins[lane].y;
+        packet.origin_z[lane] = origins[lane].z;
+        packet.inverse_direction_x[lane] = AabbTree::get_inverse_direction(directions[lane].x);
+        packet.inverse_direction_y[lane] = AabbTree::get_inverse_direction(directions[lane].y);
+        packet.inverse_direction_z[lane] = AabbTree::get_inverse_direction(directions[lane].z);
+        packet.max_distance[lane] = 300.0f;
+    }
+
+    std::array<std::vector<int>, RayPacket::k_size> packet_hits;
+    tree.raycast(packet, [&packet_hits](size_t lane, int entity_id, float) {
+        packet_hits[lane].push_back(entity_id);
+        return 300.0f;
+    });
+    for (size_t lane = 0; lane < RayPacket::k_size; lane++) {
+        std::vector<int> single_hits;
+        tree.raycast(origins[lane], directions[lane], 300.0f, [&single_hits](int entity_id, float) {
+            single_hits.push_back(entity_id);
+            return 300.0f;
+        });
+        EXPECT_FALSE(single_hits.empty());
+        EXPECT_THAT(packet_hits[lane], testing::UnorderedElementsAreArray(single_hits));
+    }
+}
+
+TEST(AabbTreeTest, RaysAlongSlabPlanes)
+{
+    // rays parallel to x starting on the x planes of the box, once with each sign of zero
+    const Aabb bounds{{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+    for (const float plane_x : {0.0f, 1.0f}) {
+        for (const float direction_x : {0.0f, -0.0f}) {
+            const Vector3f origin{plane_x, 0.5f, -5.0f};
+            const Vector3f inverse_direction{AabbTree::get_inverse_direction(direction_x),
+                AabbTree::get_inverse_direction(0.0f), AabbTree::get_inverse_direction(1.0f)};
+            EXPECT_FALSE(std::isnan((bounds.min.x - origin.x) * inverse_direction.x));
+            float distance{-1.0f};
+            const bool is_hit = AabbTree::intersect_ray(bounds, origin, inverse_direction, 100.0f, distance);
+
+            RayPacket packet;
+            for (size_t lane = 0; lane < RayPacket::k_size; lane++) {
+                packet.origin_x[lane] = origin.x;
+                packet.origin_y[lane] = origin.y;
+                packet.origin_z[lane] = origin.z;
+                packet.inverse_direction_x[lane] = inverse_direction.x;
+                packet.inverse_direction_y[lane] = inverse_direction.y;
+                packet.inverse_direction_z[lane] = inverse_direction.z;
+                packet.max_distance[lane] = 100.0f;
+            }
+            std::array<float, RayPacket::k_size> distances;
+            const int lane_mask = AabbTree::intersect_ray_packet(bounds, packet, distances);
+            EXPECT_EQ(lane_mask, is_hit ? 0b1111 : 0) << "plane " << plane_x << " direction " << direction_x;
+            if (is_hit) {
+                EXPECT_FLOAT_EQ(distances[0], distance);
+            }
+        }
+    }
+    // a ray along the plane the slab starts at enters the box
+    float distance;
+    EXPECT_TRUE(AabbTree::intersect_ray(bounds, {0.0f, 0.5f, -5.0f},
+        {AabbTree::get_inverse_direction(0.0f), AabbTree::get_inverse_direction(0.0f), 1.0f}, 100.0f, distance));
+    EXPECT_FLOAT_EQ(distance, 5.0f);
+}
+
+TEST(AabbTreeTest, FrustumQuery)
+{
+    AabbTree tree;
+    tree.update(0, box_at({0.0f, 0.0f, -10.0f}));
+    tree.update(1, box_at({0.0f, 0.0f, 10.0f}));
+    tree.update(2, box_at({100.0f, 0.0f, -10.0f}));
+
+    const Frustum frustum = Frustum::from_matrix(Matrix4x4f::perspective_matrix(0.5f, 500.0f, 1.0f, 75.0f));
+    std::vector<int> result;
+    tree.query(frustum, [&result](int entity_id) {
+        result.push_back(entity_id);
+        return true;
+    });
+    EXPECT_THAT(result, testing::ElementsAre(0));
+}
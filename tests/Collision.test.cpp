@@ -0,0 +1,193 @@
+#include <numbers>
+#include <vector>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Aabb.hpp"
+#include "ColliderComponent.hpp"
+#include "Collision.hpp"
+#include "ContactSolver.hpp"
+#include "Quaternion.hpp"
+#include "TransformComponent.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+const Aabb k_unit_bounds{{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}};
+
+auto make_shape(ColliderComponent::Shape type, const Vector3f& position,
+    const Quaternionf& rotation = Quaternionf::identity()) -> collision::Shape
+{
+    const TransformComponent transform{
+        .entity_id = 0,
+        .position = position,
+        .rotation = rotation,
+        .scale = {1.0f, 1.0f, 1.0f},
+    };
+    return collision::make_shape(type, k_unit_bounds, transform);
+}
+} // namespace
+
+TEST(CollisionTest, AabbAabb)
+{
+    using enum ColliderComponent::Shape;
+    const auto contact = collision::collide(make_shape(box, {0.0f, 0.0f, 0.0f}), make_shape(box, {0.0f, 0.8f, 0.1f}));
+    ASSERT_TRUE(contact);
+    EXPECT_FLOAT_EQ(contact->normal.y, 1.0f);
+    EXPECT_NEAR(contact->penetration, 0.2f, 1e-5f);
+
+    EXPECT_FALSE(collision::collide(make_shape(box, {0.0f, 0.0f, 0.0f}), make_shape(box, {1.1f, 0.0f, 0.0f})));
+}
+
+TEST(CollisionTest, SphereSphere)
+{
+    using enum ColliderComponent::Shape;
+    const auto contact
+        = collision::collide(make_shape(sphere, {0.0f, 0.0f, 0.0f}), make_shape(sphere, {-0.9f, 0.0f, 0.0f}));
+    ASSERT_TRUE(contact);
+    EXPECT_FLOAT_EQ(contact->normal.x, -1.0f);
+    EXPECT_NEAR(contact->penetration, 0.1f, 1e-5f);
+}
+
+TEST(CollisionTest, SphereBoxNormalPointsFromFirstShape)
+{
+    using enum ColliderComponent::Shape;
+    const auto contact
+        = collision::collide(make_shape(sphere, {0.0f, 0.9f, 0.0f}), make_shape(box, {0.0f, 0.0f, 0.0f}));
+    ASSERT_TRUE(contact);
+    EXPECT_NEAR(contact->normal.y, -1.0f, 1e-5f);
+    EXPECT_NEAR(contact->penetration, 0.1f, 1e-5f);
+}
+
+TEST(CollisionTest, RotatedBoxes)
+{
+    using enum ColliderComponent::Shape;
+    // rotated 45 degrees around z the corner reaches sqrt(2) / 2 from the center
+    const Quaternionf rotation = Quaternionf::from_axis_angle({0, 0, 1}, std::numbers::pi_v<float> / 4);
+    const auto touching
+        = collision::collide(make_shape(box, {0.0f, 0.0f, 0.0f}), make_shape(box, {1.15f, 0.0f, 0.0f}, rotation));
+    ASSERT_TRUE(touching);
+    EXPECT_NEAR(touching->normal.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(touching->penetration, 0.5f + std::numbers::sqrt2_v<float> / 2 - 1.15f, 1e-4f);
+
+    EXPECT_FALSE(
+        collision::collide(make_shape(box, {0.0f, 0.0f, 0.0f}), make_shape(box, {1.25f, 0.0f, 0.0f}, rotation)));
+}
+
+TEST(CollisionTest, Raycast)
+{
+    using enum ColliderComponent::Shape;
+    const auto box_hit = collision::raycast(make_shape(box, {0.0f, 0.0f, -5.0f}), {0.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f}, 100.0f);
+    ASSERT_TRUE(box_hit);
+    EXPECT_NEAR(box_hit->distance, 4.5f, 1e-5f);
+    EXPECT_NEAR(box_hit->normal.z, 1.0f, 1e-5f);
+
+    // the corner of the rotated box reaches sqrt(2) / 2 towards the ray
+    const Quaternionf rotation = Quaternionf::from_axis_angle({0, 1, 0}, std::numbers::pi_v<float> / 4);
+    const auto rotated_hit = collision::raycast(make_shape(box, {5.0f, 0.0f, 0.0f}, rotation), {0.0f, 0.0f, 0.0f},
+        {1.0f, 0.0f, 0.0f}, 100.0f);
+    ASSERT_TRUE(rotated_hit);
+    EXPECT_NEAR(rotated_hit->distance, 5.0f - std::numbers::sqrt2_v<float> / 2, 1e-4f);
+
+    const auto sphere_hit = collision::raycast(make_shape(sphere, {0.0f, 3.0f, 0.0f}), {0.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f}, 100.0f);
+    ASSERT_TRUE(sphere_hit);
+    EXPECT_NEAR(sphere_hit->distance, 2.5f, 1e-5f);
+    EXPECT_NEAR(sphere_hit->normal.y, -1.0f, 1e-5f);
+
+    EXPECT_FALSE(collision::raycast(make_shape(sphere, {0.0f, 3.0f, 0.0f}), {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+        2.0f));
+    EXPECT_FALSE(collision::raycast(make_shape(box, {0.0f, 0.0f, -5.0f}), {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+        100.0f));
+}
+
+TEST(ContactSolverTest, StopsApproachingBodies)
+{
+    std::vector<physics::SolverBody> bodies{
+        {.velocity = {1.0f, 0.0f, 0.0f}, .position_correction = {}, .inverse_mass = 1.0f},
+        {.velocity = {-1.0f, 0.0f, 0.0f}, .position_correction = {}, .inverse_mass = 1.0f},
+    };
+    std::vector<physics::ContactConstraint> contacts{{
+        .entity_a = 0,
+        .entity_b = 1,
+        .body_a = 0,
+        .body_b = 1,
+        .normal = {1.0f, 0.0f, 0.0f},
+        .penetration = 0.11f,
+        .restitution = 0.0f,
+        .normal_impulse = 0.0f,
+        .effective_mass = 0.0f,
+        .velocity_bias = 0.0f,
+    }};
+    physics::solve_contacts(contacts, bodies, {});
+
+    EXPECT_NEAR(bodies[0].velocity.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(bodies[1].velocity.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(contacts[0].normal_impulse, 1.0f, 1e-5f);
+    // bodies are pushed apart evenly
+    EXPECT_LT(bodies[0].position_correction.x, 0.0f);
+    EXPECT_FLOAT_EQ(bodies[0].position_correction.x, -bodies[1].position_correction.x);
+}
+
+TEST(ContactSolverTest, StaticBodyIsNotMoved)
+{
+    std::vector<physics::SolverBody> bodies{
+        {.velocity = {}, .position_correction = {}, .inverse_mass = 0.0f},
+        {.velocity = {0.0f, -2.0f, 0.0f}, .position_correction = {}, .inverse_mass = 1.0f},
+    };
+    std::vector<physics::ContactConstraint> contacts{{
+        .entity_a = 0,
+        .entity_b = 1,
+        .body_a = 0,
+        .body_b = 1,
+        .normal = {0.0f, 1.0f, 0.0f},
+        .penetration = 0.5f,
+        .restitution = 0.5f,
+        .normal_impulse = 0.0f,
+        .effective_mass = 0.0f,
+        .velocity_bias = 0.0f,
+    }};
+    physics::solve_contacts(contacts, bodies, {});
+
+    EXPECT_FLOAT_EQ(bodies[0].velocity.y, 0.0f);
+    EXPECT_FLOAT_EQ(bodies[0].position_correction.y, 0.0f);
+    EXPECT_NEAR(bodies[1].velocity.y, 1.0f, 1e-5f);
+    EXPECT_GT(bodies[1].position_correction.y, 0.0f);
+}
+
+TEST(ContactSolverTest, WarmStartMatchesPersistentContacts)
+{
+    const auto make_contact = [](int entity_a, int entity_b, const Vector3f& normal, float impulse) {
+        return physics::ContactConstraint{
+            .entity_a = entity_a,
+            .entity_b = entity_b,
+            .body_a = 0,
+            .body_b = 0,
+            .normal = normal,
+            .penetration = 0.0f,
+            .restitution = 0.0f,
+            .normal_impulse = impulse,
+            .effective_mass = 0.0f,
+            .velocity_bias = 0.0f,
+        };
+    };
+    const std::vector<physics::ContactConstraint> previous{
+        make_contact(0, 1, {0.0f, 1.0f, 0.0f}, 3.0f),
+        make_contact(0, 2, {0.0f, 1.0f, 0.0f}, 4.0f),
+        make_contact(1, 2, {0.0f, 1.0f, 0.0f}, 5.0f),
+    };
+    std::vector<physics::ContactConstraint> contacts{
+        make_contact(0, 1, {0.0f, 1.0f, 0.0f}, 0.0f),
+        // normal flipped since last frame
+        make_contact(0, 2, {1.0f, 0.0f, 0.0f}, 0.0f),
+        make_contact(1, 3, {0.0f, 1.0f, 0.0f}, 0.0f),
+    };
+    physics::warm_start_contacts(contacts, previous);
+
+    EXPECT_FLOAT_EQ(contacts[0].normal_impulse, 3.0f);
+    EXPECT_FLOAT_EQ(contacts[1].normal_impulse, 0.0f);
+    EXPECT_FLOAT_EQ(contacts[2].normal_impulse, 0.0f);
+}
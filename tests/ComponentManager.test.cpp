@@ -32,3 +32,40 @@ TEST(ComponentManagerTest, GetNonexistingComponents)
     ComponentManager component_manager;
     EXPECT_DEATH(component_manager.get_components<TransformComponent>(), "not registered");
 }
+
+TEST(ComponentManagerTest, FindAfterRemove)
+{
+    ComponentManager component_manager;
+    component_manager.register_component<TransformComponent>();
+    auto& transforms = component_manager.get_components<TransformComponent>();
+    for (int entity_id = 0; entity_id < 4; entity_id++) {
+        transforms.insert_component({.entity_id = entity_id, .position = {}, .rotation = {}, .scale = {}});
+    }
+
+    transforms.remove_component(1);
+    EXPECT_EQ(transforms.find_component(1), nullptr);
+    for (int entity_id : {0, 2, 3}) {
+        ASSERT_NE(transforms.find_component(entity_id), nullptr);
+        EXPECT_EQ(transforms.find_component(entity_id)->entity_id, entity_id);
+    }
+    EXPECT_EQ(transforms.size(), 3u);
+}
+
+TEST(ComponentManagerTest, InsertDuplicateComponent)
+{
+    ComponentManager component_manager;
+    component_manager.register_component<TransformComponent>();
+    auto& transforms = component_manager.get_components<TransformComponent>();
+    transforms.insert_component({.entity_id = 2, .position = {}, .rotation = {}, .scale = {}});
+    EXPECT_DEATH(transforms.insert_component({.entity_id = 2, .position = {}, .rotation = {}, .scale = {}}),
+        "already has one");
+}
+
+TEST(ComponentManagerTest, InsertNegativeEntityId)
+{
+    ComponentManager component_manager;
+    component_manager.register_component<TransformComponent>();
+    auto& transforms = component_manager.get_components<TransformComponent>();
+    EXPECT_DEATH(transforms.insert_component({.entity_id = -1, .position = {}, .rotation = {}, .scale = {}}),
+        "negative entity id");
+}
@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Frustum.hpp"
+#include "Matrix4x4.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+const Frustum k_frustum = Frustum::from_matrix(Matrix4x4f::perspective_matrix(0.5f, 500.0f, 1.0f, 75.0f));
+} // namespace
+
+TEST(FrustumTest, IntersectsSphere)
+{
+    // in front, behind, far to the side but large enough to reach in, past the far plane
+    EXPECT_TRUE(k_frustum.intersects_sphere({0.0f, 0.0f, -10.0f}, 1.0f));
+    EXPECT_FALSE(k_frustum.intersects_sphere({0.0f, 0.0f, 10.0f}, 1.0f));
+    EXPECT_TRUE(k_frustum.intersects_sphere({100.0f, 0.0f, -10.0f}, 100.0f));
+    EXPECT_FALSE(k_frustum.intersects_sphere({0.0f, 0.0f, -600.0f}, 1.0f));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <SDL.h>
+#include <SDL_video.h>
+#include <gtest/gtest.h>
+
+#include "Logger.hpp"
+
+// Fixture with a hidden window and a current 4.5 core context. Tests are
+// skipped on machines without one, a software renderer like Mesa llvmpipe
+// is enough.
+class GlTest : public testing::Test {
+protected:
+    SDL_Window* window_{nullptr};
+    SDL_GLContext context_{nullptr};
+
+    auto SetUp() -> void override
+    {
+        Logger::set_default(Logger::create_console_logger(Logger::LogLevel::warning));
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            GTEST_SKIP() << "No video: " << SDL_GetError();
+        }
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        window_ = SDL_CreateWindow("test", 0, 0, 16, 16, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        if (window_ == nullptr) {
+            GTEST_SKIP() << "No window: " << SDL_GetError();
+        }
+        context_ = SDL_GL_CreateContext(window_);
+        if (context_ == nullptr || glewInit() != GLEW_OK) {
+            GTEST_SKIP() << "No OpenGL 4.5 context: " << SDL_GetError();
+        }
+    }
+
+    auto TearDown() -> void override
+    {
+        if (context_ != nullptr) {
+            SDL_GL_DeleteContext(context_);
+        }
+        if (window_ != nullptr) {
+            SDL_DestroyWindow(window_);
+        }
+        SDL_Quit();
+    }
+};
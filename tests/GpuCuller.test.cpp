@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <GL/glew.h>
+#include <gmock/gmock.h> // IWYU pragma: keep
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Frustum.hpp"
+#include "GlTest.hpp"
+#include "GpuCuller.hpp"
+#include "Matrix4x4.hpp"
+#include "Mesh.hpp"
+#include "ProgramCache.hpp"
+#include "Quaternion.hpp"
+#include "TransformComponent.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+using GpuCullerTest = GlTest;
+
+template<typename T>
+auto create_buffer(const std::vector<T>& data) -> GLuint
+{
+    GLuint buffer;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, data.size() * sizeof(T), data.data(), 0);
+    return buffer;
+}
+
+template<typename T>
+auto read_buffer(GLuint buffer, size_t count) -> std::vector<T>
+{
+    std::vector<T> data(count);
+    glGetNamedBufferSubData(buffer, 0, count * sizeof(T), data.data());
+    return data;
+}
+} // namespace
+
+TEST_F(GpuCullerTest, MatchesCpuFrustumTest)
+{
+    ProgramCache program_cache;
+    GpuCuller culler;
+    ASSERT_TRUE(culler.create(program_cache));
+
+    const Frustum frustum = Frustum::from_matrix(Matrix4x4f::perspective_matrix(0.5f, 500.0f, 1.0f, 75.0f));
+    const std::vector<std::array<float, 4>> bounding_spheres{{0.0f, 0.0f, 0.0f, 0.5f}, {0.0f, 1.0f, 0.0f, 2.0f}};
+    constexpr uint32_t k_instances_per_draw = 500;
+
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<float> position{-300.0f, 300.0f};
+    std::uniform_real_distribution<float> scale{0.2f, 8.0f};
+    std::uniform_real_distribution<float> angle{0.0f, 6.0f};
+    std::vector<GpuCuller::Instance> instances;
+    // visible models of every draw
+    std::array<std::vector<std::array<float, 16>>, 2> expected;
+    for (uint32_t i = 0; i < 2 * k_instances_per_draw; i++) {
+        const TransformComponent transform{
+            .entity_id = 0,
+            .position = {position(generator), position(generator), position(generator)},
+            .rotation = Quaternionf::from_axis_angle(Vector3f{1.0f, 2.0f, 3.0f}.normalized(), angle(generator)),
+            .scale = {scale(generator), scale(generator), scale(generator)},
+        };
+        const uint32_t draw_index = i % 2;
+        const Matrix4x4f model = Matrix4x4f::from_transform(transform);
+        instances.push_back({.model = model, .draw_index = draw_index, .padding = {}});
+
+        const auto& sphere = bounding_spheres[draw_index];
+        const float max_scale = std::max({transform.scale.x, transform.scale.y, transform.scale.z});
+        if (frustum.intersects_sphere(model * Vector3f{sphere[0], sphere[1], sphere[2]}, sphere[3] * max_scale)) {
+            expected[draw_index].push_back(model.data);
+        }
+    }
+    ASSERT_FALSE(expected[0].empty() || expected[1].empty());
+
+    const std::vector<Mesh::DrawElementsIndirectCommand> draw_commands{
+        {.count = 36, .instanceCount = 0, .firstIndex = 0, .baseVertex = 0, .baseInstance = 0},
+        {.count = 18, .instanceCount = 0, .firstIndex = 36, .baseVertex = 24, .baseInstance = k_instances_per_draw},
+    };
+    const GLuint instance_buffer = create_buffer(instances);
+    const GLuint sphere_buffer = create_buffer(bounding_spheres);
+    const GLuint draw_command_buffer = create_buffer(draw_commands);
+    culler.cull(frustum, {instance_buffer, 0, instances.size() * sizeof(GpuCuller::Instance)},
+        {sphere_buffer, 0, bounding_spheres.size() * sizeof(bounding_spheres[0])},
+        {draw_command_buffer, 0, draw_commands.size() * sizeof(Mesh::DrawElementsIndirectCommand)});
+
+    const auto culled_commands = read_buffer<Mesh::DrawElementsIndirectCommand>(draw_command_buffer, 2);
+    const auto visible = read_buffer<std::array<float, 16>>(culler.get_visible_instance_buffer(), instances.size());
+    for (uint32_t draw = 0; draw < 2; draw++) {
+        EXPECT_EQ(culled_commands[draw].count, draw_commands[draw].count);
+        EXPECT_EQ(culled_commands[draw].baseInstance, draw_commands[draw].baseInstance);
+        ASSERT_EQ(culled_commands[draw].instanceCount, expected[draw].size());
+        const auto first = visible.begin() + culled_commands[draw].baseInstance;
+        const std::vector<std::array<float, 16>> visible_models(first, first + culled_commands[draw].instanceCount);
+        EXPECT_THAT(visible_models, testing::UnorderedElementsAreArray(expected[draw]));
+    }
+
+    const GLuint buffers[]{instance_buffer, sphere_buffer, draw_command_buffer};
+    glDeleteBuffers(3, buffers);
+}
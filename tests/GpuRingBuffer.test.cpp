@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <GL/glew.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "GlTest.hpp"
+#include "GpuRingBuffer.hpp"
+
+namespace
+{
+using GpuRingBufferTest = GlTest;
+} // namespace
+
+TEST_F(GpuRingBufferTest, AllocationsStayInsideTheirFrame)
+{
+    GpuRingBuffer ring;
+    ASSERT_TRUE(ring.create(256));
+    for (size_t frame = 0; frame < 2 * GpuRingBuffer::k_frame_count; frame++) {
+        ring.begin_frame();
+        const auto first = ring.allocate(10, 4);
+        const auto second = ring.allocate(100, 64);
+        ASSERT_TRUE(first && second);
+        EXPECT_EQ(second->offset % 64, 0);
+        EXPECT_GE(second->offset, first->offset + 10);
+        EXPECT_EQ(first->offset / 256, second->offset / 256);
+        // the rest of the frame's region is too small
+        EXPECT_FALSE(ring.allocate(200, 4));
+        ring.end_frame();
+    }
+}
+
+TEST_F(GpuRingBufferTest, ConsecutiveFramesUseSeparateRegions)
+{
+    GpuRingBuffer ring;
+    ASSERT_TRUE(ring.create(256));
+    std::vector<GLintptr> offsets;
+    for (size_t frame = 0; frame < GpuRingBuffer::k_frame_count + 1; frame++) {
+        ring.begin_frame();
+        offsets.push_back(ring.allocate(16, 16)->offset);
+        ring.end_frame();
+    }
+    EXPECT_NE(offsets[0], offsets[1]);
+    EXPECT_NE(offsets[1], offsets[2]);
+    EXPECT_NE(offsets[0], offsets[2]);
+    // the region is reused once the fence of the first frame has signaled
+    EXPECT_EQ(offsets[0], offsets[GpuRingBuffer::k_frame_count]);
+}
+
+TEST_F(GpuRingBufferTest, WritesAreVisibleToTheGpu)
+{
+    GpuRingBuffer ring;
+    ASSERT_TRUE(ring.create(1024));
+    ring.begin_frame();
+    const std::vector<uint32_t> data{1, 2, 3, 4, 5};
+    const auto allocation = ring.allocate(data.size() * sizeof(uint32_t), 16);
+    ASSERT_TRUE(allocation);
+    std::memcpy(allocation->data, data.data(), data.size() * sizeof(uint32_t));
+
+    // copy on the gpu and read the copy back, the mapping is coherent so no flush is needed
+    GLuint copy;
+    glCreateBuffers(1, &copy);
+    glNamedBufferStorage(copy, data.size() * sizeof(uint32_t), nullptr, 0);
+    glCopyNamedBufferSubData(ring.get_buffer(), copy, allocation->offset, 0, data.size() * sizeof(uint32_t));
+    ring.end_frame();
+    std::vector<uint32_t> read_back(data.size());
+    glGetNamedBufferSubData(copy, 0, read_back.size() * sizeof(uint32_t), read_back.data());
+    glDeleteBuffers(1, &copy);
+    EXPECT_EQ(read_back, data);
+}
@@ -0,0 +1,55 @@
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Mesh.hpp"
+#include "Vector3.hpp"
+
+TEST(MeshTest, SelectLodHysteresis)
+{
+    const std::vector<Mesh::Lod> lods{
+        {.mesh_name = "lod1", .max_screen_size = 0.5f},
+        {.mesh_name = "lod2", .max_screen_size = 0.1f},
+    };
+    EXPECT_EQ(Mesh::select_lod(lods, 1.0f, 0), 0);
+    EXPECT_EQ(Mesh::select_lod(lods, 0.05f, 0), 2);
+    EXPECT_EQ(Mesh::select_lod(lods, 0.3f, 2), 1);
+
+    // just below a threshold keeps the finer level and just above it keeps the coarser one
+    EXPECT_EQ(Mesh::select_lod(lods, 0.48f, 0), 0);
+    EXPECT_EQ(Mesh::select_lod(lods, 0.52f, 1), 1);
+    EXPECT_EQ(Mesh::select_lod(lods, 0.44f, 0), 1);
+    EXPECT_EQ(Mesh::select_lod(lods, 0.56f, 1), 0);
+
+    EXPECT_EQ(Mesh::select_lod({}, 0.01f, 0), 0);
+}
+
+TEST(MeshTest, SphereLodsGetCoarser)
+{
+    const auto sphere = Mesh::load("sphere");
+    ASSERT_TRUE(sphere);
+    ASSERT_EQ(sphere->lods.size(), 2);
+    size_t previous_index_count = sphere->indices.size();
+    for (const Mesh::Lod& lod : sphere->lods) {
+        const auto lod_mesh = Mesh::load(lod.mesh_name);
+        ASSERT_TRUE(lod_mesh);
+        EXPECT_LT(lod_mesh->indices.size(), previous_index_count);
+        previous_index_count = lod_mesh->indices.size();
+    }
+
+    // triangles face outwards
+    for (size_t i = 0; i < sphere->indices.size(); i += 3) {
+        const auto vertex = [&sphere](size_t index) {
+            const size_t v = sphere->indices[index] * 3;
+            return Vector3f{sphere->vertices[v], sphere->vertices[v + 1], sphere->vertices[v + 2]};
+        };
+        const Vector3f a = vertex(i);
+        const Vector3f normal = (vertex(i + 1) - a).cross(vertex(i + 2) - a);
+        // the triangles touching the poles are degenerate
+        EXPECT_GE(normal.dot(a + vertex(i + 1) + vertex(i + 2)), -1e-6f);
+    }
+    EXPECT_NEAR(sphere->local_bounding_sphere().radius, 1.0f, 1e-5f);
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "GlTest.hpp"
+#include "Mesh.hpp"
+#include "MeshArena.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshRegistry.hpp"
+
+namespace
+{
+using MeshArenaTest = GlTest;
+
+// position and color of every vertex of the arena
+auto read_vertices(const MeshArena& arena, size_t first_vertex, size_t vertex_count)
+    -> std::pair<std::vector<float>, std::vector<float>>
+{
+    const Mesh::VertexLayout& layout = arena.get_vertex_layout();
+    std::vector<std::byte> data(vertex_count * layout.stride);
+    glGetNamedBufferSubData(arena.get_vertex_buffer(), first_vertex * layout.stride, data.size(), data.data());
+    std::vector<float> positions;
+    std::vector<float> colors;
+    for (size_t i = 0; i < vertex_count; i++) {
+        const std::byte* vertex = data.data() + i * layout.stride;
+        for (size_t axis = 0; axis < 3; axis++) {
+            if (layout.position_type == GL_HALF_FLOAT) {
+                uint16_t half;
+                std::memcpy(&half, vertex + axis * sizeof(half), sizeof(half));
+                // only normal numbers and zero are expected
+                const int exponent = (half >> 10) & 0x1f;
+                const float magnitude = exponent == 0
+                    ? 0.0f
+                    : std::ldexp(1.0f + static_cast<float>(half & 0x3ff) / 1024.0f, exponent - 15);
+                positions.push_back((half & 0x8000) != 0 ? -magnitude : magnitude);
+            }
+            else {
+                float position;
+                std::memcpy(&position, vertex + axis * sizeof(position), sizeof(position));
+                positions.push_back(position);
+            }
+        }
+        for (size_t channel = 0; channel < 4; channel++) {
+            colors.push_back(static_cast<float>(vertex[layout.color_offset + channel]) / 255.0f);
+        }
+    }
+    return {positions, colors};
+}
+
+// built in mesh as the registry stores it
+auto load_optimized(std::string_view mesh_name) -> Mesh
+{
+    Mesh mesh = *Mesh::load(mesh_name);
+    mesh_optimize::optimize(mesh);
+    return mesh;
+}
+} // namespace
+
+TEST_F(MeshArenaTest, UploadsMeshesOnce)
+{
+    MeshRegistry registry;
+    const auto cube_mesh = registry.load("cube");
+    const auto pyramid_mesh = registry.load("pyramid");
+    ASSERT_TRUE(cube_mesh && pyramid_mesh);
+    MeshArena arena{registry};
+    arena.create(1024, 1024);
+
+    // uploaded in the order they are first drawn
+    const auto cube = arena.get_draw_command(*cube_mesh);
+    const auto pyramid = arena.get_draw_command(*pyramid_mesh);
+    EXPECT_EQ(cube.count, registry.get_indices(*cube_mesh).size() / sizeof(uint16_t));
+    EXPECT_EQ(pyramid.firstIndex, cube.count);
+    EXPECT_EQ(pyramid.baseVertex, static_cast<int32_t>(load_optimized("cube").vertices.size() / 3));
+    EXPECT_EQ(arena.get_draw_command(*cube_mesh).firstIndex, cube.firstIndex);
+
+    // meshes loaded after the arena was created are uploaded too
+    const auto sphere_mesh = registry.load("sphere");
+    ASSERT_TRUE(sphere_mesh);
+    EXPECT_EQ(arena.get_draw_command(*sphere_mesh).firstIndex, cube.count + pyramid.count);
+}
+
+TEST_F(MeshArenaTest, GrowingKeepsUploadedMeshes)
+{
+    MeshRegistry registry;
+    const auto cube_handle = registry.load("cube");
+    const auto pyramid_handle = registry.load("pyramid");
+    ASSERT_TRUE(cube_handle && pyramid_handle);
+    MeshArena arena{registry};
+    // too small for either mesh
+    arena.create(4, 4);
+    arena.get_draw_command(*cube_handle);
+    const auto& pyramid = arena.get_draw_command(*pyramid_handle);
+
+    const Mesh cube_mesh = load_optimized("cube");
+    const Mesh pyramid_mesh = load_optimized("pyramid");
+    EXPECT_EQ(read_vertices(arena, 0, cube_mesh.vertices.size() / 3).first, cube_mesh.vertices);
+    const auto [pyramid_positions, pyramid_colors]
+        = read_vertices(arena, pyramid.baseVertex, pyramid_mesh.vertices.size() / 3);
+    EXPECT_EQ(pyramid_positions, pyramid_mesh.vertices);
+    // the mesh colors are all exactly representable with 8 bits
+    EXPECT_EQ(pyramid_colors, pyramid_mesh.colors);
+
+    std::vector<std::byte> indices(pyramid_mesh.indices.size() * sizeof(uint16_t));
+    glGetNamedBufferSubData(
+        arena.get_index_buffer(), pyramid.firstIndex * sizeof(uint16_t), indices.size(), indices.data());
+    EXPECT_EQ(indices, pyramid_mesh.pack_indices());
+}
+
+TEST_F(MeshArenaTest, HalfFloatPositions)
+{
+    MeshRegistry registry{Mesh::PositionFormat::float16};
+    const auto sphere_handle = registry.load("sphere");
+    ASSERT_TRUE(sphere_handle);
+    MeshArena arena{registry};
+    arena.create(1024, 1024);
+    EXPECT_EQ(arena.get_vertex_layout().stride, 12);
+    arena.get_draw_command(*sphere_handle);
+
+    const Mesh sphere = load_optimized("sphere");
+    const auto positions = read_vertices(arena, 0, sphere.vertices.size() / 3).first;
+    ASSERT_EQ(positions.size(), sphere.vertices.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        // half floats have 11 bits of precision, values below 2^-14 are flushed to zero
+        EXPECT_NEAR(positions[i], sphere.vertices[i], std::max(std::fabs(sphere.vertices[i]) / 2048.0f, 1e-4f));
+    }
+}
@@ -0,0 +1,193 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Logger.hpp"
+#include "Mesh.hpp"
+#include "MeshImporter.hpp"
+
+namespace
+{
+template <typename T>
+auto append(std::vector<std::byte>& data, const T& value) -> void
+{
+    const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+// binary glTF file with the json and binary chunks, both padded to four bytes
+auto make_glb(std::string json, std::vector<std::byte> binary) -> std::vector<std::byte>
+{
+    json.resize((json.size() + 3) / 4 * 4, ' ');
+    binary.resize((binary.size() + 3) / 4 * 4);
+    std::vector<std::byte> data;
+    append(data, uint32_t{0x46546c67});
+    append(data, uint32_t{2});
+    append(data, static_cast<uint32_t>(12 + 8 + json.size() + 8 + binary.size()));
+    append(data, static_cast<uint32_t>(json.size()));
+    append(data, uint32_t{0x4e4f534a});
+    for (const char character : json) {
+        data.push_back(static_cast<std::byte>(character));
+    }
+    append(data, static_cast<uint32_t>(binary.size()));
+    append(data, uint32_t{0x004e4942});
+    data.insert(data.end(), binary.begin(), binary.end());
+    return data;
+}
+} // namespace
+
+TEST(MeshImporterTest, ObjPolygonsAndColors)
+{
+    const auto mesh = mesh_import::from_obj(
+        "# quad\n"
+        "o quad\n"
+        "v -1 -1 0 1 0 0\r\n"
+        "v 1 -1 0 0 1 0\n"
+        "v 1 1 0 0 0 1\n"
+        "v -1 1 0\n"
+        "vt 0 0\n"
+        "f 1/1 2/1 3/1 -1/1\n");
+    ASSERT_TRUE(mesh);
+    EXPECT_EQ(mesh->vertices.size(), 12);
+    EXPECT_EQ(mesh->indices, (std::vector<uint32_t>{0, 1, 2, 0, 2, 3}));
+    ASSERT_EQ(mesh->colors.size(), 16);
+    EXPECT_EQ(mesh->colors[4 + 1], 1.0f);
+    // vertices without a color are white
+    EXPECT_EQ(mesh->colors[12], 1.0f);
+    EXPECT_TRUE(mesh->lods.empty());
+
+    // no colors at all leaves them to the default
+    const auto uncolored = mesh_import::from_obj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+    ASSERT_TRUE(uncolored);
+    EXPECT_TRUE(uncolored->colors.empty());
+}
+
+TEST(MeshImporterTest, GlbIndexedPrimitive)
+{
+    std::vector<std::byte> binary;
+    for (const float position : {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f}) {
+        append(binary, position);
+    }
+    // normalized RGBA8 colors
+    for (const uint8_t channel : {255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255}) {
+        append(binary, channel);
+    }
+    for (const uint16_t index : {0, 2, 1}) {
+        append(binary, index);
+    }
+    const std::string json = R"({
+        "asset": {"version": "2.0", "generator": "test \"quoted\" é"},
+        "buffers": [{"byteLength": 54}],
+        "bufferViews": [
+            {"buffer": 0, "byteOffset": 0, "byteLength": 36},
+            {"buffer": 0, "byteOffset": 36, "byteLength": 12},
+            {"buffer": 0, "byteOffset": 48, "byteLength": 6}
+        ],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0]},
+            {"bufferView": 1, "componentType": 5121, "normalized": true, "count": 3, "type": "VEC4"},
+            {"bufferView": 2, "componentType": 5123, "count": 3, "type": "SCALAR"}
+        ],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0, "COLOR_0": 1}, "indices": 2, "mode": 4}]}]
+    })";
+
+    const auto mesh = mesh_import::from_glb(make_glb(json, binary));
+    ASSERT_TRUE(mesh);
+    EXPECT_EQ(mesh->vertices, (std::vector<float>{0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f}));
+    EXPECT_EQ(mesh->indices, (std::vector<uint32_t>{0, 2, 1}));
+    EXPECT_EQ(mesh->colors,
+        (std::vector<float>{1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f}));
+}
+
+TEST(MeshImporterTest, RejectsBrokenFiles)
+{
+    Logger::set_default(Logger::create_console_logger(Logger::LogLevel::none));
+    EXPECT_FALSE(mesh_import::from_obj("v 0 0 0\nv 1 0 0\nf 1 2 3\n"));
+    EXPECT_FALSE(mesh_import::from_obj("v 0 0\n"));
+    EXPECT_FALSE(mesh_import::from_obj(""));
+
+    std::vector<std::byte> positions;
+    for (int i = 0; i < 9; i++) {
+        append(positions, 0.0f);
+    }
+    const std::string out_of_bounds_json = R"({
+        "bufferViews": [{"buffer": 0, "byteLength": 36}],
+        "accessors": [{"bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3"}],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}}]}]
+    })";
+    EXPECT_FALSE(mesh_import::from_glb(make_glb(out_of_bounds_json, positions)));
+    EXPECT_FALSE(mesh_import::from_glb(make_glb(R"({"meshes": [)", positions)));
+    EXPECT_FALSE(mesh_import::from_glb(std::as_bytes(std::span{"glTF"})));
+
+    // indices that are not unsigned integers
+    std::vector<std::byte> float_indices = positions;
+    for (const float index : {0.0f, 1.0f, -1.0f}) {
+        append(float_indices, index);
+    }
+    const std::string float_indices_json = R"({
+        "bufferViews": [{"buffer": 0, "byteLength": 36}, {"buffer": 0, "byteOffset": 36, "byteLength": 12}],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"},
+            {"bufferView": 1, "componentType": 5126, "count": 3, "type": "SCALAR"}
+        ],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1}]}]
+    })";
+    EXPECT_FALSE(mesh_import::from_glb(make_glb(float_indices_json, float_indices)));
+    std::vector<std::byte> normalized_indices = positions;
+    for (const uint8_t index : {0, 1, 2}) {
+        append(normalized_indices, index);
+    }
+    const std::string normalized_indices_json = R"({
+        "bufferViews": [{"buffer": 0, "byteLength": 36}, {"buffer": 0, "byteOffset": 36, "byteLength": 3}],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"},
+            {"bufferView": 1, "componentType": 5121, "normalized": true, "count": 3, "type": "SCALAR"}
+        ],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1}]}]
+    })";
+    EXPECT_FALSE(mesh_import::from_glb(make_glb(normalized_indices_json, normalized_indices)));
+
+    // a stride smaller than an element would let a few bytes claim any count
+    const std::string zero_stride_json = R"({
+        "bufferViews": [{"buffer": 0, "byteLength": 36, "byteStride": 0}],
+        "accessors": [{"bufferView": 0, "componentType": 5126, "count": 4294967295, "type": "VEC3"}],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}}]}]
+    })";
+    EXPECT_FALSE(mesh_import::from_glb(make_glb(zero_stride_json, positions)));
+    const std::string unaligned_stride_json = R"({
+        "bufferViews": [{"buffer": 0, "byteLength": 36, "byteStride": 13}],
+        "accessors": [{"bufferView": 0, "componentType": 5126, "count": 2, "type": "VEC3"}],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}}]}]
+    })";
+    EXPECT_FALSE(mesh_import::from_glb(make_glb(unaligned_stride_json, positions)));
+    // a valid stride is still read
+    const std::string strided_json = R"({
+        "bufferViews": [{"buffer": 0, "byteLength": 36, "byteStride": 12}],
+        "accessors": [{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"}],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}}]}]
+    })";
+    EXPECT_TRUE(mesh_import::from_glb(make_glb(strided_json, positions)));
+
+    // header length of 0 and a JSON chunk claiming far more than the file
+    std::vector<std::byte> bad_length;
+    append(bad_length, uint32_t{0x46546c67});
+    append(bad_length, uint32_t{2});
+    append(bad_length, uint32_t{0});
+    append(bad_length, uint32_t{0x7fffffff});
+    append(bad_length, uint32_t{0x4e4f534a});
+    append(bad_length, uint32_t{0});
+    ASSERT_EQ(bad_length.size(), 24u);
+    EXPECT_FALSE(mesh_import::from_glb(bad_length));
+    // header length past the end of the file
+    std::vector<std::byte> truncated = make_glb(R"({"meshes": []})", positions);
+    truncated.resize(truncated.size() - 4);
+    EXPECT_FALSE(mesh_import::from_glb(truncated));
+}
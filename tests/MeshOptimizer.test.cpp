@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <GL/glew.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Mesh.hpp"
+#include "MeshOptimizer.hpp"
+
+namespace
+{
+// grid of size by size quads with every triangle in random order
+auto make_shuffled_grid(uint32_t size) -> Mesh
+{
+    Mesh grid;
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            grid.vertices.insert(grid.vertices.end(), {static_cast<float>(x), static_cast<float>(y), 0.0f});
+        }
+    }
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            const uint32_t a = y * (size + 1) + x;
+            triangles.push_back({a, a + 1, a + size + 1});
+            triangles.push_back({a + 1, a + size + 2, a + size + 1});
+        }
+    }
+    std::ranges::shuffle(triangles, std::mt19937{42});
+    for (const auto& triangle : triangles) {
+        grid.indices.insert(grid.indices.end(), triangle.begin(), triangle.end());
+    }
+    return grid;
+}
+
+// every triangle by its positions, rotated to start at its smallest corner so winding is kept
+auto get_triangles(const Mesh& mesh) -> std::vector<std::array<float, 9>>
+{
+    std::vector<std::array<float, 9>> triangles;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        std::array<std::array<float, 3>, 3> corners;
+        for (size_t corner = 0; corner < 3; corner++) {
+            std::copy_n(mesh.vertices.begin() + mesh.indices[i + corner] * 3, 3, corners[corner].begin());
+        }
+        std::ranges::rotate(corners, std::ranges::min_element(corners));
+        std::array<float, 9> triangle;
+        for (size_t corner = 0; corner < 3; corner++) {
+            std::ranges::copy(corners[corner], triangle.begin() + corner * 3);
+        }
+        triangles.push_back(triangle);
+    }
+    std::ranges::sort(triangles);
+    return triangles;
+}
+} // namespace
+
+TEST(MeshOptimizerTest, RemovesDuplicateVertices)
+{
+    // a quad whose triangles do not share vertices, the last vertex only differs in color
+    Mesh quad;
+    quad.vertices = {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0, 1, 0};
+    quad.colors.assign(7 * 4, 1.0f);
+    quad.colors[6 * 4] = 0.0f;
+    quad.indices = {0, 1, 2, 3, 4, 5, 3, 4, 6};
+    mesh_optimize::remove_duplicate_vertices(quad);
+    EXPECT_EQ(quad.vertices.size(), 5 * 3);
+    EXPECT_EQ(quad.colors.size(), 5 * 4);
+    EXPECT_EQ(quad.indices, (std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 0, 2, 4}));
+}
+
+TEST(MeshOptimizerTest, ReordersForVertexCache)
+{
+    Mesh grid = make_shuffled_grid(32);
+    const auto triangles = get_triangles(grid);
+    const size_t vertex_count = grid.vertices.size() / 3;
+    const float shuffled_ratio
+        = mesh_optimize::get_average_cache_miss_ratio(grid.indices, vertex_count, mesh_optimize::k_cache_size);
+    mesh_optimize::optimize_vertex_cache(grid.indices, vertex_count);
+    const float optimized_ratio
+        = mesh_optimize::get_average_cache_miss_ratio(grid.indices, vertex_count, mesh_optimize::k_cache_size);
+    // a shuffled grid misses almost every vertex, an optimized one gets close to the 0.5 of a perfect order
+    EXPECT_GT(shuffled_ratio, 1.5f);
+    EXPECT_LT(optimized_ratio, 0.8f);
+    EXPECT_EQ(get_triangles(grid), triangles);
+}
+
+TEST(MeshOptimizerTest, OrdersVerticesByFirstUse)
+{
+    Mesh grid = make_shuffled_grid(8);
+    // a vertex no triangle uses
+    grid.vertices.insert(grid.vertices.end(), {-1.0f, -1.0f, -1.0f});
+    const auto triangles = get_triangles(grid);
+    mesh_optimize::optimize(grid);
+    EXPECT_EQ(grid.vertices.size(), 9 * 9 * 3);
+    EXPECT_TRUE(grid.colors.empty());
+    uint32_t next_vertex{0};
+    for (const uint32_t index : grid.indices) {
+        ASSERT_LE(index, next_vertex);
+        next_vertex = std::max(next_vertex, index + 1);
+    }
+    EXPECT_EQ(get_triangles(grid), triangles);
+}
+
+TEST(MeshOptimizerTest, WidensIndicesForLargeMeshes)
+{
+    Mesh mesh = make_shuffled_grid(8);
+    EXPECT_EQ(mesh.get_index_type(), GL_UNSIGNED_SHORT);
+    EXPECT_EQ(mesh.pack_indices().size(), mesh.indices.size() * sizeof(uint16_t));
+
+    // more vertices than 16 bit indices address
+    mesh.vertices.resize(70000 * 3);
+    mesh.indices.insert(mesh.indices.end(), {69999, 0, 1});
+    EXPECT_EQ(mesh.get_index_type(), GL_UNSIGNED_INT);
+    const auto packed = mesh.pack_indices();
+    ASSERT_EQ(packed.size(), mesh.indices.size() * sizeof(uint32_t));
+    uint32_t last_index;
+    std::memcpy(&last_index, packed.data() + packed.size() - 3 * sizeof(uint32_t), sizeof(last_index));
+    EXPECT_EQ(last_index, 69999);
+}
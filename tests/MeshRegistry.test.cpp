@@ -0,0 +1,118 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Logger.hpp"
+#include "Mesh.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshRegistry.hpp"
+
+namespace
+{
+auto write_file(const std::filesystem::path& path, std::string_view contents) -> void
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file{path, std::ios_base::binary | std::ios_base::trunc};
+    file << contents;
+}
+} // namespace
+
+TEST(MeshRegistryTest, LoadsMeshesOnce)
+{
+    MeshRegistry registry;
+    const auto cube = registry.load("cube");
+    const auto pyramid = registry.load("pyramid");
+    ASSERT_TRUE(cube && pyramid);
+    EXPECT_EQ(cube->index, 0);
+    EXPECT_EQ(pyramid->index, 1);
+    EXPECT_EQ(registry.load("cube"), cube);
+    EXPECT_EQ(registry.size(), 2);
+
+    // meshes are stored optimized
+    Mesh cube_mesh = *Mesh::load("cube");
+    mesh_optimize::optimize(cube_mesh);
+    EXPECT_EQ(registry.get_vertices(*cube).size(), cube_mesh.vertices.size() / 3 * 16);
+    EXPECT_EQ(registry.get_index_type(*cube), GL_UNSIGNED_SHORT);
+    EXPECT_EQ(std::vector<std::byte>(registry.get_indices(*cube).begin(), registry.get_indices(*cube).end()),
+        cube_mesh.pack_indices());
+    // the cube's corners are sqrt(3) / 2 from its center
+    EXPECT_NEAR(registry.get_bounding_sphere(*cube).radius, 0.8660254f, 1e-5f);
+    EXPECT_FLOAT_EQ(registry.get_bounds(*pyramid).max.y, 1.0f);
+}
+
+TEST(MeshRegistryTest, MeshesDoNotMove)
+{
+    MeshRegistry registry;
+    const auto cube = registry.load("cube");
+    ASSERT_TRUE(cube);
+    const std::byte* cube_vertices = registry.get_vertices(*cube).data();
+    // loads every level of the sphere as well
+    ASSERT_TRUE(registry.load("sphere"));
+    ASSERT_TRUE(registry.load("pyramid"));
+    EXPECT_EQ(registry.get_vertices(*cube).data(), cube_vertices);
+}
+
+TEST(MeshRegistryTest, ResolvesLods)
+{
+    MeshRegistry registry;
+    const auto sphere = registry.load("sphere");
+    ASSERT_TRUE(sphere);
+    const auto lods = registry.get_lods(*sphere);
+    ASSERT_EQ(lods.size(), 2);
+    EXPECT_EQ(registry.get_lod(*sphere, 0), sphere);
+    for (size_t level = 1; level <= lods.size(); level++) {
+        EXPECT_EQ(registry.get_lod(*sphere, level), registry.load(lods[level - 1].mesh_name));
+    }
+    EXPECT_EQ(registry.size(), 3);
+}
+
+TEST(MeshRegistryTest, BakesImportedMeshes)
+{
+    Logger::set_default(Logger::create_console_logger(Logger::LogLevel::warning));
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "not-doom-mesh-registry-test";
+    std::filesystem::remove_all(directory);
+    const std::filesystem::path asset_directory = directory / "assets";
+    const std::filesystem::path cache_directory = directory / "cache";
+    const std::filesystem::path source_path = asset_directory / "props" / "triangle.obj";
+    write_file(source_path, "v 0 0 0 1 0 0\nv 1 0 0 0 1 0\nv 0 2 0 0 0 1\nf 1 2 3\n");
+
+    // vertices are ordered by first use, so the first one is the first vertex of the face
+    const auto load_first_vertex = [&] {
+        MeshRegistry registry{Mesh::PositionFormat::float32, asset_directory, cache_directory};
+        const auto triangle = registry.load("props/triangle");
+        EXPECT_TRUE(triangle);
+        if (!triangle) {
+            return std::array<float, 3>{};
+        }
+        EXPECT_EQ(registry.get_vertices(*triangle).size(), 3 * 16);
+        EXPECT_FLOAT_EQ(registry.get_bounds(*triangle).max.y, 2.0f);
+        EXPECT_EQ(registry.get_indices(*triangle).size(), 3 * sizeof(uint16_t));
+        std::array<float, 3> position;
+        std::memcpy(position.data(), registry.get_vertices(*triangle).data(), sizeof(position));
+        return position;
+    };
+    EXPECT_EQ(load_first_vertex(), (std::array{0.0f, 0.0f, 0.0f}));
+    EXPECT_TRUE(std::filesystem::exists(cache_directory / "props" / "triangle.mesh"));
+
+    // the same size and modification time count as unchanged, so the baked mesh is used without parsing
+    const auto write_time = std::filesystem::last_write_time(source_path);
+    write_file(source_path, "v 0 0 0 1 0 0\nv 1 0 0 0 1 0\nv 0 2 0 0 0 1\nf 3 2 1\n");
+    std::filesystem::last_write_time(source_path, write_time);
+    EXPECT_EQ(load_first_vertex(), (std::array{0.0f, 0.0f, 0.0f}));
+
+    // changed sources are imported again
+    write_file(source_path, "v 0 0 0 1 0 0\nv 1 0 0 0 1 0\nv 0 2 0 0 0 1\nf 3 2 1\n\n");
+    EXPECT_EQ(load_first_vertex(), (std::array{0.0f, 2.0f, 0.0f}));
+
+    std::filesystem::remove_all(directory);
+}
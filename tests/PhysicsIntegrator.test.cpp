@@ -0,0 +1,84 @@
+#include <cstddef>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "PhysicsIntegrator.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+auto make_bodies(size_t count) -> physics::BodyStreams
+{
+    physics::BodyStreams bodies;
+    for (size_t i = 0; i < count; i++) {
+        const float f = static_cast<float>(i);
+        bodies.push_back(static_cast<int>(i), {f, -f, f * 0.5f}, {0.1f * f, 1.0f, -0.2f}, {0.0f, -0.01f * f, 0.3f},
+            i % 3 == 0, i % 4 == 0 ? 2.5f : 1.0f, i % 4 == 0 ? 3 : 1);
+    }
+    return bodies;
+}
+} // namespace
+
+TEST(PhysicsIntegratorTest, MatchesClosedForm)
+{
+    physics::BodyStreams bodies;
+    bodies.push_back(0, {1.0f, 2.0f, 3.0f}, {1.0f, 0.0f, -1.0f}, {0.0f, 2.0f, 0.0f}, true);
+    physics::integrate(bodies, 2.0f, 0.1f);
+
+    const Vector3f position = bodies.position(0);
+    const Vector3f velocity = bodies.velocity(0);
+    EXPECT_FLOAT_EQ(position.x, 3.0f);
+    EXPECT_FLOAT_EQ(position.y, 2.0f + 4.0f - 0.1f);
+    EXPECT_FLOAT_EQ(position.z, 1.0f);
+    EXPECT_FLOAT_EQ(velocity.x, 1.0f);
+    EXPECT_FLOAT_EQ(velocity.y, 4.0f);
+    EXPECT_FLOAT_EQ(velocity.z, -1.0f);
+}
+
+TEST(PhysicsIntegratorTest, SkippedStepsScaleTimeAndGravity)
+{
+    physics::BodyStreams bodies;
+    // stepped once after skipping two steps, 3 steps worth of time and gravity
+    bodies.push_back(0, {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 2.0f}, true, 3.0f, 3);
+    physics::integrate(bodies, 2.0f, 0.1f);
+
+    const Vector3f position = bodies.position(0);
+    EXPECT_FLOAT_EQ(position.x, 6.0f);
+    EXPECT_FLOAT_EQ(position.y, -0.3f);
+    EXPECT_FLOAT_EQ(position.z, 36.0f);
+    EXPECT_FLOAT_EQ(bodies.velocity(0).z, 12.0f);
+}
+
+TEST(PhysicsIntegratorTest, BatchMatchesScalar)
+{
+    // odd count so both the wide loop and the scalar tail are exercised
+    constexpr size_t body_count = 37;
+    physics::BodyStreams batch = make_bodies(body_count);
+    physics::BodyStreams scalar = make_bodies(body_count);
+
+    physics::integrate(batch, 16.0f, 0.1f);
+    physics::integrate_scalar(scalar, 0, body_count, 16.0f, 0.1f);
+
+    for (size_t i = 0; i < body_count; i++) {
+        EXPECT_FLOAT_EQ(batch.position_x[i], scalar.position_x[i]);
+        EXPECT_FLOAT_EQ(batch.position_y[i], scalar.position_y[i]);
+        EXPECT_FLOAT_EQ(batch.position_z[i], scalar.position_z[i]);
+        EXPECT_FLOAT_EQ(batch.velocity_x[i], scalar.velocity_x[i]);
+        EXPECT_FLOAT_EQ(batch.velocity_y[i], scalar.velocity_y[i]);
+        EXPECT_FLOAT_EQ(batch.velocity_z[i], scalar.velocity_z[i]);
+    }
+}
+
+TEST(PhysicsIntegratorTest, RangeLeavesOtherBodiesUntouched)
+{
+    physics::BodyStreams bodies = make_bodies(20);
+    const physics::BodyStreams original = bodies;
+    physics::integrate(bodies, 5, 15, 1.0f, 0.1f);
+
+    for (size_t i = 0; i < 20; i++) {
+        const bool in_range = i >= 5 && i < 15;
+        EXPECT_EQ(bodies.position_z[i] != original.position_z[i], in_range) << "body " << i;
+    }
+}
@@ -0,0 +1,37 @@
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h> // IWYU pragma: keep
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "PhysicsIslands.hpp"
+
+TEST(PhysicsIslandsTest, GroupsConnectedBodies)
+{
+    // 0 - 3 - 1 form a stack, 2 rests alone on static ground, 4 touches nothing
+    const std::vector<std::pair<int, int>> contacts{{3, 1}, {-1, 2}, {0, 3}, {0, -1}};
+    physics::Islands islands;
+    physics::build_islands(5, contacts, islands);
+
+    ASSERT_EQ(islands.size(), 3);
+    EXPECT_THAT(islands.get_bodies(0), testing::ElementsAre(0, 1, 3));
+    EXPECT_THAT(islands.get_contacts(0), testing::ElementsAre(0, 2, 3));
+    EXPECT_THAT(islands.get_bodies(1), testing::ElementsAre(2));
+    EXPECT_THAT(islands.get_contacts(1), testing::ElementsAre(1));
+    EXPECT_THAT(islands.get_bodies(2), testing::ElementsAre(4));
+    EXPECT_TRUE(islands.get_contacts(2).empty());
+}
+
+TEST(PhysicsIslandsTest, StaticBodiesDoNotJoinIslands)
+{
+    // both bodies rest on the same static ground
+    const std::vector<std::pair<int, int>> contacts{{-1, 0}, {-1, 1}};
+    physics::Islands islands;
+    physics::build_islands(2, contacts, islands);
+
+    ASSERT_EQ(islands.size(), 2);
+    EXPECT_THAT(islands.get_bodies(0), testing::ElementsAre(0));
+    EXPECT_THAT(islands.get_bodies(1), testing::ElementsAre(1));
+}
@@ -0,0 +1,368 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "ColliderComponent.hpp"
+#include "ComponentManager.hpp"
+#include "ComponentVector.hpp"
+#include "MeshComponent.hpp"
+#include "MeshRegistry.hpp"
+#include "PhysicsComponent.hpp"
+#include "PhysicsWorld.hpp"
+#include "Quaternion.hpp"
+#include "TransformComponent.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+constexpr float k_delta_time = 16.0f;
+
+auto register_components(ComponentManager& component_manager) -> void
+{
+    component_manager.register_component<TransformComponent>();
+    component_manager.register_component<MeshComponent>();
+    component_manager.register_component<PhysicsComponent>();
+    component_manager.register_component<ColliderComponent>();
+}
+
+// unit cube, static unless it gets a physics component
+auto add_cube(ComponentManager& component_manager, MeshHandle cube, int entity_id, const Vector3f& position,
+    const Vector3f& scale = {1.0f, 1.0f, 1.0f}) -> void
+{
+    component_manager.get_components<TransformComponent>().insert_component({
+        .entity_id = entity_id,
+        .position = position,
+        .rotation = Quaternionf::identity(),
+        .scale = scale,
+    });
+    component_manager.get_components<MeshComponent>().insert_component({
+        .entity_id = entity_id,
+        .mesh = cube,
+    });
+}
+
+auto add_body(ComponentManager& component_manager, int entity_id, const Vector3f& velocity,
+    bool is_affected_by_gravity = true) -> PhysicsComponent&
+{
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+    physics_vector.insert_component({
+        .entity_id = entity_id,
+        .velocity = velocity,
+        .acceleration = {},
+        .is_affected_by_gravity = is_affected_by_gravity,
+    });
+    return *physics_vector.find_component(entity_id);
+}
+
+auto get_position(ComponentManager& component_manager, int entity_id) -> Vector3f
+{
+    return component_manager.get_components<TransformComponent>().find_component(entity_id)->position;
+}
+
+// positions of every entity after dropping columns of cubes onto a floor, enough of them that every stage is
+// split between the threads
+auto simulate_stacks(size_t worker_count) -> std::vector<Vector3f>
+{
+    constexpr int grid_size = 20;
+    constexpr int layer_count = 3;
+    MeshRegistry mesh_registry;
+    const MeshHandle cube = *mesh_registry.load("cube");
+    ComponentManager component_manager;
+    register_components(component_manager);
+
+    int entity_id{0};
+    add_cube(component_manager, cube, entity_id++, {0.0f, -0.5f, 0.0f}, {60.0f, 1.0f, 60.0f});
+    for (int x = 0; x < grid_size; x++) {
+        for (int z = 0; z < grid_size; z++) {
+            for (int layer = 0; layer < layer_count; layer++) {
+                const Vector3f position{(x - grid_size / 2) * 1.05f, 0.6f + layer * 1.1f, (z - grid_size / 2) * 1.05f};
+                add_cube(component_manager, cube, entity_id, position);
+                add_body(component_manager, entity_id, {0.001f * static_cast<float>(entity_id % 5 - 2), 0.0f, 0.0f});
+                entity_id++;
+            }
+        }
+    }
+
+    PhysicsWorld physics_world{mesh_registry, worker_count};
+    for (int step = 0; step < 30; step++) {
+        physics_world.step(component_manager, k_delta_time);
+    }
+    std::vector<Vector3f> positions;
+    for (int i = 0; i < entity_id; i++) {
+        positions.push_back(get_position(component_manager, i));
+    }
+    return positions;
+}
+} // namespace
+
+TEST(PhysicsWorldTest, SameResultForAnyWorkerCount)
+{
+    const std::vector<Vector3f> expected = simulate_stacks(0);
+    // the cubes came to rest on the floor instead of falling through it
+    EXPECT_GT(expected[1].y, 0.0f);
+    for (const size_t worker_count : {1, 3, 7}) {
+        const std::vector<Vector3f> positions = simulate_stacks(worker_count);
+        ASSERT_EQ(positions.size(), expected.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            // bit identical, not just close
+            ASSERT_EQ(positions[i].x, expected[i].x) << "entity " << i << " with " << worker_count << " workers";
+            ASSERT_EQ(positions[i].y, expected[i].y) << "entity " << i << " with " << worker_count << " workers";
+            ASSERT_EQ(positions[i].z, expected[i].z) << "entity " << i << " with " << worker_count << " workers";
+        }
+    }
+}
+
+TEST(PhysicsWorldTest, RaycastFindsClosestUnfilteredHit)
+{
+    MeshRegistry mesh_registry;
+    const MeshHandle cube = *mesh_registry.load("cube");
+    ComponentManager component_manager;
+    register_components(component_manager);
+    add_cube(component_manager, cube, 0, {5.0f, 0.0f, 0.0f});
+    add_cube(component_manager, cube, 1, {10.0f, 0.0f, 0.0f});
+    add_cube(component_manager, cube, 2, {15.0f, 0.0f, 0.0f});
+    component_manager.get_components<ColliderComponent>().insert_component({
+        .entity_id = 2,
+        .shape = ColliderComponent::Shape::sphere,
+        .restitution = 0.0f,
+    });
+    PhysicsWorld physics_world{mesh_registry, 0};
+    physics_world.step(component_manager, k_delta_time);
+
+    const Vector3f origin{0.0f, 0.0f, 0.0f};
+    const Vector3f direction{1.0f, 0.0f, 0.0f};
+    const auto hit = physics_world.raycast(origin, direction, 100.0f);
+    ASSERT_TRUE(hit);
+    EXPECT_EQ(hit->entity_id, 0);
+    EXPECT_FLOAT_EQ(hit->distance, 4.5f);
+    EXPECT_FLOAT_EQ(hit->point.x, 4.5f);
+    EXPECT_FLOAT_EQ(hit->normal.x, -1.0f);
+
+    const auto skip_first = [](int entity_id) { return entity_id != 0; };
+    const auto filtered_hit = physics_world.raycast(origin, direction, 100.0f, skip_first);
+    ASSERT_TRUE(filtered_hit);
+    EXPECT_EQ(filtered_hit->entity_id, 1);
+    EXPECT_FLOAT_EQ(filtered_hit->distance, 9.5f);
+
+    // the sphere fitted to the cube has the radius of its half extents
+    const auto sphere_hit = physics_world.raycast(origin, direction, 100.0f, [](int entity_id) {
+        return entity_id == 2;
+    });
+    ASSERT_TRUE(sphere_hit);
+    EXPECT_FLOAT_EQ(sphere_hit->distance, 14.5f);
+
+    EXPECT_FALSE(physics_world.raycast(origin, direction, 4.0f));
+    EXPECT_FALSE(physics_world.raycast(origin, {0.0f, 1.0f, 0.0f}, 100.0f));
+}
+
+TEST(PhysicsWorldTest, SphereCastFindsClosestUnfilteredHit)
+{
+    MeshRegistry mesh_registry;
+    const MeshHandle cube = *mesh_registry.load("cube");
+    ComponentManager component_manager;
+    register_components(component_manager);
+    // both off the line of the center, only a sphere reaches them
+    add_cube(component_manager, cube, 0, {5.0f, 1.2f, 0.0f});
+    add_cube(component_manager, cube, 1, {10.0f, -1.2f, 0.0f});
+    PhysicsWorld physics_world{mesh_registry, 0};
+    physics_world.step(component_manager, k_delta_time);
+
+    const Vector3f origin{0.0f, 0.0f, 0.0f};
+    const Vector3f direction{1.0f, 0.0f, 0.0f};
+    EXPECT_FALSE(physics_world.raycast(origin, direction, 100.0f));
+    const auto hit = physics_world.sphere_cast(origin, 1.0f, direction, 100.0f);
+    ASSERT_TRUE(hit);
+    EXPECT_EQ(hit->entity_id, 0);
+    EXPECT_FLOAT_EQ(hit->distance, 3.5f);
+    EXPECT_FLOAT_EQ(hit->point.x, 4.5f);
+    EXPECT_FLOAT_EQ(hit->normal.x, -1.0f);
+
+    const auto filtered_hit = physics_world.sphere_cast(origin, 1.0f, direction, 100.0f, [](int entity_id) {
+        return entity_id != 0;
+    });
+    ASSERT_TRUE(filtered_hit);
+    EXPECT_EQ(filtered_hit->entity_id, 1);
+    EXPECT_FLOAT_EQ(filtered_hit->distance, 8.5f);
+
+    // a filtered out shape is passed through and a smaller sphere misses
+    EXPECT_FALSE(physics_world.sphere_cast(origin, 1.0f, direction, 100.0f, [](int) { return false; }));
+    EXPECT_FALSE(physics_world.sphere_cast(origin, 0.5f, direction, 100.0f));
+}
+
+TEST(PhysicsWorldTest, BatchedRaycastsMatchSingleRaycasts)
+{
+    MeshRegistry mesh_registry;
+    const MeshHandle cube = *mesh_registry.load("cube");
+    ComponentManager component_manager;
+    register_components(component_manager);
+    for (int i = 0; i < 8; i++) {
+        add_cube(component_manager, cube, i, {static_cast<float>(i) * 3.0f, 0.0f, 5.0f});
+    }
+    PhysicsWorld physics_world{mesh_registry, 3};
+    physics_world.step(component_manager, k_delta_time);
+
+    // more rays than fit in whole packets, a few of them miss or run out of distance
+    std::vector<Ray> rays;
+    for (int i = 0; i < 11; i++) {
+        rays.push_back({
+            .origin = {static_cast<float>(i) * 2.0f, 0.0f, 0.0f},
+            .direction = {0.0f, 0.0f, 1.0f},
+            .max_distance = i == 4 ? 2.0f : 100.0f,
+        });
+    }
+    // called from several threads at once
+    std::atomic<int> filter_calls{0};
+    const PhysicsWorld::RaycastFilter filter = [&filter_calls](int entity_id) {
+        filter_calls++;
+        return entity_id != 3;
+    };
+    std::vector<std::optional<RaycastHit>> hits(rays.size());
+    physics_world.raycast(rays, hits, filter);
+    EXPECT_GT(filter_calls.load(), 0);
+
+    int hit_count{0};
+    for (size_t i = 0; i < rays.size(); i++) {
+        const auto expected = physics_world.raycast(rays[i].origin, rays[i].direction, rays[i].max_distance, filter);
+        ASSERT_EQ(hits[i].has_value(), expected.has_value()) << "ray " << i;
+        if (expected) {
+            EXPECT_EQ(hits[i]->entity_id, expected->entity_id) << "ray " << i;
+            EXPECT_EQ(hits[i]->distance, expected->distance) << "ray " << i;
+            EXPECT_NE(hits[i]->entity_id, 3);
+            hit_count++;
+        }
+    }
+    EXPECT_GT(hit_count, 0);
+    EXPECT_LT(hit_count, static_cast<int>(rays.size()));
+}
+
+TEST(PhysicsWorldTest, BulletsStopAtThinWalls)
+{
+    // moves 16 units a step, far more than the wall is thick
+    constexpr float speed = 1.0f;
+    const auto shoot = [](bool is_bullet, float start_x) {
+        MeshRegistry mesh_registry;
+        const MeshHandle cube = *mesh_registry.load("cube");
+        ComponentManager component_manager;
+        register_components(component_manager);
+        add_cube(component_manager, cube, 0, {5.0f, 0.0f, 0.0f}, {0.1f, 4.0f, 4.0f});
+        add_cube(component_manager, cube, 1, {start_x, 0.0f, 0.0f}, {0.2f, 0.2f, 0.2f});
+        add_body(component_manager, 1, {speed, 0.0f, 0.0f}, false).is_bullet = is_bullet;
+        PhysicsWorld physics_world{mesh_registry, 0};
+        for (int step = 0; step < 3; step++) {
+            physics_world.step(component_manager, k_delta_time);
+        }
+        return get_position(component_manager, 1).x;
+    };
+
+    // without sweeping it tunnels through
+    EXPECT_GT(shoot(false, 0.0f), 5.0f);
+    EXPECT_LT(shoot(true, 0.0f), 5.0f);
+    // starting out overlapping the wall it still does not pass through
+    EXPECT_LT(shoot(true, 4.9f), 5.0f);
+}
+
+TEST(PhysicsWorldTest, BulletsSlideAlongWhatTheyTouch)
+{
+    MeshRegistry mesh_registry;
+    const MeshHandle cube = *mesh_registry.load("cube");
+    ComponentManager component_manager;
+    register_components(component_manager);
+    // resting on the floor, touching it from the start
+    add_cube(component_manager, cube, 0, {0.0f, -0.5f, 0.0f}, {100.0f, 1.0f, 100.0f});
+    add_cube(component_manager, cube, 1, {0.0f, 0.1f, 0.0f}, {0.2f, 0.2f, 0.2f});
+    add_body(component_manager, 1, {1.0f, 0.0f, 0.0f}, false).is_bullet = true;
+    PhysicsWorld physics_world{mesh_registry, 0};
+    physics_world.step(component_manager, k_delta_time);
+    EXPECT_FLOAT_EQ(get_position(component_manager, 1).x, 16.0f);
+}
+
+TEST(PhysicsWorldTest, FarBodiesStepLessOften)
+{
+    MeshRegistry mesh_registry;
+    ComponentManager component_manager;
+    register_components(component_manager);
+    const Vector3f velocity{0.001f, 0.0f, 0.0f};
+    // one body per tier, the far ones twice with ids staggering them onto different steps
+    const std::array<Vector3f, 5> start_positions{{
+        {0.0f, 0.0f, 0.0f},
+        {100.0f, 0.0f, 0.0f},
+        {0.0f, 100.0f, 0.0f},
+        {200.0f, 0.0f, 0.0f},
+        {0.0f, 200.0f, 0.0f},
+    }};
+    for (int entity_id = 0; entity_id < static_cast<int>(start_positions.size()); entity_id++) {
+        component_manager.get_components<TransformComponent>().insert_component({
+            .entity_id = entity_id,
+            .position = start_positions[entity_id],
+            .rotation = Quaternionf::identity(),
+            .scale = {1.0f, 1.0f, 1.0f},
+        });
+        add_body(component_manager, entity_id, velocity, false);
+    }
+    PhysicsWorld physics_world{mesh_registry, 0};
+    physics_world.set_lod_center({0.0f, 0.0f, 0.0f});
+    auto& physics_vector = component_manager.get_components<PhysicsComponent>();
+    const auto get_moved = [&](int entity_id) {
+        return get_position(component_manager, entity_id).x - start_positions[entity_id].x;
+    };
+
+    physics_world.step(component_manager, k_delta_time);
+    EXPECT_FLOAT_EQ(get_moved(0), velocity.x * k_delta_time);
+    // every second step, starting at the first or second by entity id
+    EXPECT_FLOAT_EQ(get_moved(1), 0.0f);
+    EXPECT_FLOAT_EQ(physics_vector.find_component(1)->skipped_time, k_delta_time);
+    EXPECT_EQ(physics_vector.find_component(1)->skipped_steps, 1);
+    EXPECT_FLOAT_EQ(get_moved(2), velocity.x * k_delta_time);
+    // every fourth step
+    EXPECT_FLOAT_EQ(get_moved(3), 0.0f);
+    EXPECT_FLOAT_EQ(get_moved(4), velocity.x * k_delta_time);
+
+    physics_world.step(component_manager, k_delta_time);
+    // the skipped time is made up for on the next step of the body
+    EXPECT_NEAR(get_moved(1), velocity.x * 2 * k_delta_time, 1e-4f);
+    EXPECT_FLOAT_EQ(physics_vector.find_component(1)->skipped_time, 0.0f);
+    EXPECT_EQ(physics_vector.find_component(1)->skipped_steps, 0);
+    EXPECT_FLOAT_EQ(get_moved(2), velocity.x * k_delta_time);
+    EXPECT_NEAR(get_moved(3), velocity.x * 2 * k_delta_time, 1e-4f);
+    EXPECT_EQ(physics_vector.find_component(4)->skipped_steps, 1);
+
+    for (int step = 2; step < 8; step++) {
+        physics_world.step(component_manager, k_delta_time);
+    }
+    // no time is lost, what a body has not moved yet is still waiting for its next step
+    for (int entity_id = 0; entity_id < static_cast<int>(start_positions.size()); entity_id++) {
+        const float pending_time = physics_vector.find_component(entity_id)->skipped_time;
+        EXPECT_NEAR(get_moved(entity_id) + velocity.x * pending_time, velocity.x * 8 * k_delta_time, 1e-4f)
+            << "entity " << entity_id;
+    }
+}
+
+TEST(PhysicsWorldTest, BodiesSkippingTheStepDoNotCollide)
+{
+    MeshRegistry mesh_registry;
+    const MeshHandle cube = *mesh_registry.load("cube");
+    ComponentManager component_manager;
+    register_components(component_manager);
+    // overlapping far away, both skip the first step and take the second
+    add_cube(component_manager, cube, 1, {100.0f, 0.0f, 0.0f});
+    add_cube(component_manager, cube, 3, {100.5f, 0.0f, 0.0f});
+    add_body(component_manager, 1, {}, false);
+    add_body(component_manager, 3, {}, false);
+    PhysicsWorld physics_world{mesh_registry, 0};
+    physics_world.set_lod_center({0.0f, 0.0f, 0.0f});
+
+    physics_world.step(component_manager, k_delta_time);
+    EXPECT_EQ(physics_world.get_pairs().size(), 1);
+    EXPECT_TRUE(physics_world.get_contacts().empty());
+
+    physics_world.step(component_manager, k_delta_time);
+    ASSERT_EQ(physics_world.get_contacts().size(), 1);
+    EXPECT_EQ(physics_world.get_contacts().front().entity_a, 1);
+    EXPECT_EQ(physics_world.get_contacts().front().entity_b, 3);
+}
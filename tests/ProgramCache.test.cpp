@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "GlTest.hpp"
+#include "ProgramCache.hpp"
+
+namespace
+{
+using ProgramCacheTest = GlTest;
+
+constexpr std::string_view k_compute_shader = R"(
+#version 450 core
+
+layout (local_size_x = 1) in;
+layout (std430, binding = 0) writeonly buffer Result
+{
+    uint result;
+};
+
+void main()
+{
+    result = 42u;
+}
+)";
+
+auto read_file(const std::filesystem::path& path) -> std::vector<char>
+{
+    std::ifstream file{path, std::ios_base::binary};
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+// runs the program and returns what it wrote
+auto run(GLuint program) -> uint32_t
+{
+    GLuint buffer;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, sizeof(uint32_t), nullptr, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+    glUseProgram(program);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    uint32_t result{0};
+    glGetNamedBufferSubData(buffer, 0, sizeof(result), &result);
+    glUseProgram(0);
+    glDeleteBuffers(1, &buffer);
+    return result;
+}
+} // namespace
+
+TEST_F(ProgramCacheTest, ReusesLinkedBinaries)
+{
+    GLint binary_format_count{0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_count);
+    if (binary_format_count == 0) {
+        GTEST_SKIP() << "The driver has no program binary formats.";
+    }
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "not-doom-program-cache-test";
+    std::filesystem::remove_all(directory);
+    const ProgramCache::ShaderSource shader_source{.type = GL_COMPUTE_SHADER, .source = k_compute_shader};
+
+    const auto create_program = [&] {
+        ProgramCache program_cache{directory};
+        const std::optional<GLuint> program
+            = program_cache.wait_program(program_cache.submit_program({&shader_source, 1}));
+        EXPECT_TRUE(program);
+        if (program) {
+            EXPECT_EQ(run(*program), 42);
+        }
+    };
+    create_program();
+    ASSERT_FALSE(std::filesystem::is_empty(directory));
+    const std::filesystem::path binary_path = std::filesystem::directory_iterator{directory}->path();
+    const std::vector<char> binary = read_file(binary_path);
+
+    // a binary the driver accepts is used as is
+    create_program();
+    EXPECT_EQ(read_file(binary_path), binary);
+
+    // a damaged binary falls back to compiling and is replaced
+    std::vector<char> damaged = binary;
+    for (size_t i = damaged.size() / 2; i < damaged.size(); i++) {
+        damaged[i] = static_cast<char>(~damaged[i]);
+    }
+    std::ofstream{binary_path, std::ios_base::binary | std::ios_base::trunc}.write(
+        damaged.data(), static_cast<std::streamsize>(damaged.size()));
+    create_program();
+    EXPECT_EQ(read_file(binary_path), binary);
+
+    // so is a header claiming a binary larger than the file, its size is the last field of the 32 byte header
+    std::vector<char> oversized = binary;
+    std::fill_n(oversized.begin() + 28, sizeof(uint32_t), static_cast<char>(0xff));
+    std::ofstream{binary_path, std::ios_base::binary | std::ios_base::trunc}.write(
+        oversized.data(), static_cast<std::streamsize>(oversized.size()));
+    create_program();
+    EXPECT_EQ(read_file(binary_path), binary);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(ProgramCacheTest, PollsSubmittedPrograms)
+{
+    Logger::set_default(Logger::create_console_logger(Logger::LogLevel::none));
+    ProgramCache program_cache;
+    const ProgramCache::ShaderSource shader_source{.type = GL_COMPUTE_SHADER, .source = k_compute_shader};
+    const ProgramCache::ShaderSource broken_source{.type = GL_COMPUTE_SHADER, .source = "#version 450 core\nnope"};
+    const ProgramHandle program = program_cache.submit_program({&shader_source, 1});
+    const ProgramHandle broken_program = program_cache.submit_program({&broken_source, 1});
+    EXPECT_EQ(program.index, 0);
+    EXPECT_EQ(broken_program.index, 1);
+
+    // submitted together, polled until both are done
+    ProgramStatus status;
+    while ((status = program_cache.poll_program(program)) == ProgramStatus::compiling) {
+        EXPECT_FALSE(program_cache.get_program(program));
+    }
+    EXPECT_EQ(status, ProgramStatus::ready);
+    ASSERT_TRUE(program_cache.get_program(program));
+    EXPECT_EQ(run(*program_cache.get_program(program)), 42);
+
+    while ((status = program_cache.poll_program(broken_program)) == ProgramStatus::compiling) {
+    }
+    EXPECT_EQ(status, ProgramStatus::failed);
+    EXPECT_FALSE(program_cache.get_program(broken_program));
+    EXPECT_FALSE(program_cache.wait_program(broken_program));
+}
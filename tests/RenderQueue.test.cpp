@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "RenderQueue.hpp"
+
+TEST(RenderQueueTest, SortMatchesStableSort)
+{
+    std::mt19937_64 generator{42};
+    // few distinct high bits like real keys, so some digits are skipped
+    std::uniform_int_distribution<uint64_t> high{0, 3};
+    std::uniform_int_distribution<uint64_t> low{0, 1000};
+    RenderQueue queue;
+    std::vector<RenderQueue::Item> expected;
+    for (uint32_t i = 0; i < 5000; i++) {
+        const uint64_t key = high(generator) << 50 | low(generator);
+        queue.push(key, i);
+        expected.push_back({.key = key, .index = i});
+    }
+    queue.sort();
+    std::ranges::stable_sort(expected, {}, &RenderQueue::Item::key);
+
+    const auto items = queue.get_items();
+    ASSERT_EQ(items.size(), expected.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        EXPECT_EQ(items[i].key, expected[i].key);
+        EXPECT_EQ(items[i].index, expected[i].index);
+    }
+}
+
+TEST(RenderQueueTest, KeysOrderByPassShaderIndexWidthMeshAndDepth)
+{
+    using enum RenderPass;
+    RenderQueue queue;
+    queue.push(RenderQueue::make_key(transparent, 1, false, 0, 5.0f), 0);
+    queue.push(RenderQueue::make_key(transparent, 1, false, 0, 10.0f), 1);
+    queue.push(RenderQueue::make_key(opaque, 2, false, 0, 1.0f), 2);
+    queue.push(RenderQueue::make_key(opaque, 1, false, 3, 1.0f), 3);
+    queue.push(RenderQueue::make_key(opaque, 1, false, 2, 20.0f), 4);
+    queue.push(RenderQueue::make_key(opaque, 1, false, 2, 0.5f), 5);
+    // wide indices after every narrow mesh of the shader, whatever its mesh
+    queue.push(RenderQueue::make_key(opaque, 1, true, 1, 0.5f), 6);
+    queue.sort();
+
+    std::vector<uint32_t> order;
+    for (const auto& item : queue.get_items()) {
+        order.push_back(item.index);
+    }
+    // opaque front to back and transparent back to front
+    EXPECT_EQ(order, (std::vector<uint32_t>{5, 4, 3, 6, 2, 1, 0}));
+
+    const uint64_t key = RenderQueue::make_key(opaque, 7, true, 123, 3.0f);
+    EXPECT_EQ(RenderQueue::get_pass(key), opaque);
+    EXPECT_EQ(RenderQueue::get_shader(key), 7);
+    EXPECT_TRUE(RenderQueue::get_wide_indices(key));
+    EXPECT_EQ(RenderQueue::get_mesh(key), 123);
+    EXPECT_EQ(RenderQueue::get_batch(key), RenderQueue::get_batch(RenderQueue::make_key(opaque, 7, true, 123, 9.0f)));
+}
+
+TEST(RenderQueueTest, IndicesOutsideTheirBits)
+{
+    EXPECT_DEATH(RenderQueue::make_key(RenderPass::opaque, 1u << RenderQueue::k_shader_bits, false, 0, 1.0f),
+        "Shader index does not fit into a render key");
+    EXPECT_DEATH(RenderQueue::make_key(RenderPass::opaque, 0, false, 1u << RenderQueue::k_mesh_bits, 1.0f),
+        "Mesh index does not fit into a render key");
+}
@@ -0,0 +1,104 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <SDL_image.h>
+#include <SDL_pixels.h>
+#include <SDL_surface.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "GlTest.hpp"
+#include "Logger.hpp"
+#include "ResourceManager.hpp"
+
+namespace
+{
+using ResourceManagerTest = GlTest;
+
+// saves a size x size png of a single color
+auto save_patch(const std::filesystem::path& path, int size, uint32_t rgba) -> bool
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (surface == nullptr) {
+        return false;
+    }
+    for (int y = 0; y < size; y++) {
+        uint8_t* row = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
+        for (int x = 0; x < size; x++) {
+            row[x * 4 + 0] = static_cast<uint8_t>(rgba >> 24);
+            row[x * 4 + 1] = static_cast<uint8_t>(rgba >> 16);
+            row[x * 4 + 2] = static_cast<uint8_t>(rgba >> 8);
+            row[x * 4 + 3] = static_cast<uint8_t>(rgba);
+        }
+    }
+    const bool is_saved = IMG_SavePNG(surface, path.string().c_str()) == 0;
+    SDL_FreeSurface(surface);
+    return is_saved;
+}
+
+// first pixel of the layer at the mip level, as rgba
+auto read_pixel(GLuint texture_array, GLint level, GLint layer) -> std::array<uint8_t, 4>
+{
+    std::array<uint8_t, 4> pixel{};
+    glGetTextureSubImage(texture_array, level, 0, 0, layer, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel.size(),
+        pixel.data());
+    return pixel;
+}
+} // namespace
+
+TEST_F(ResourceManagerTest, PacksTexturesIntoArrayLayers)
+{
+    Logger::set_default(Logger::create_console_logger(Logger::LogLevel::none));
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "not-doom-texture-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "patches");
+    ASSERT_TRUE(save_patch(directory / "patches" / "red.png", 8, 0xff0000ff));
+    ASSERT_TRUE(save_patch(directory / "patches" / "green.png", 8, 0x00ff00ff));
+    ASSERT_TRUE(save_patch(directory / "patches" / "blue.png", 4, 0x0000ffff));
+
+    ResourceManager resource_manager{directory};
+    const std::vector<std::string> names{"red", "blue", "missing", "green", "red"};
+    resource_manager.load_textures(names);
+    const auto red = resource_manager.get_texture("red");
+    const auto green = resource_manager.get_texture("green");
+    const auto blue = resource_manager.get_texture("blue");
+    ASSERT_TRUE(red && green && blue);
+    EXPECT_FALSE(resource_manager.get_texture("missing"));
+    // names that failed are not tried again
+    ASSERT_TRUE(save_patch(directory / "patches" / "missing.png", 8, 0xffffffff));
+    EXPECT_FALSE(resource_manager.get_texture("missing"));
+    // loaded once
+    resource_manager.load_textures(names);
+    EXPECT_EQ(resource_manager.get_texture("red"), red);
+
+    // images of the same size share an array
+    const auto texture_arrays = resource_manager.get_texture_arrays();
+    ASSERT_EQ(texture_arrays.size(), 2);
+    const ResourceManager::TextureLayer red_layer = resource_manager.get_texture_layer(*red);
+    const ResourceManager::TextureLayer green_layer = resource_manager.get_texture_layer(*green);
+    const ResourceManager::TextureLayer blue_layer = resource_manager.get_texture_layer(*blue);
+    EXPECT_EQ(red_layer.array_index, green_layer.array_index);
+    EXPECT_NE(red_layer.layer, green_layer.layer);
+    EXPECT_NE(red_layer.array_index, blue_layer.array_index);
+    EXPECT_EQ(blue_layer.layer, 0);
+
+    // every mip level down to 1x1 is generated
+    const GLuint red_array = texture_arrays[red_layer.array_index];
+    GLint level_count{0};
+    glGetTextureParameteriv(red_array, GL_TEXTURE_IMMUTABLE_LEVELS, &level_count);
+    EXPECT_EQ(level_count, 4);
+    EXPECT_EQ(read_pixel(red_array, 3, red_layer.layer), (std::array<uint8_t, 4>{0xff, 0x00, 0x00, 0xff}));
+    EXPECT_EQ(read_pixel(red_array, 3, green_layer.layer), (std::array<uint8_t, 4>{0x00, 0xff, 0x00, 0xff}));
+    const GLuint blue_array = texture_arrays[blue_layer.array_index];
+    EXPECT_EQ(read_pixel(blue_array, 0, 0), (std::array<uint8_t, 4>{0x00, 0x00, 0xff, 0xff}));
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+    resource_manager.destroy();
+    EXPECT_TRUE(resource_manager.get_texture_arrays().empty());
+    std::filesystem::remove_all(directory);
+}
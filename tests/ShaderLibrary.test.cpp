@@ -0,0 +1,145 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string_view>
+
+#include <GL/glew.h>
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "GlTest.hpp"
+#include "Logger.hpp"
+#include "ProgramCache.hpp"
+#include "ShaderLibrary.hpp"
+
+namespace
+{
+using ShaderLibraryTest = GlTest;
+
+auto write_file(const std::filesystem::path& path, std::string_view contents) -> void
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file{path, std::ios_base::binary | std::ios_base::trunc};
+    file << contents;
+}
+
+// compute shader writing RESULT, which includes.glsl defines from VALUE
+constexpr std::string_view k_compute_shader = R"(#version 450 core
+#include "value.glsl"
+layout (local_size_x = 1) in;
+layout (std430, binding = 0) writeonly buffer Result
+{
+    uint result;
+};
+
+void main()
+{
+    result = RESULT;
+}
+)";
+
+auto run(GLuint program) -> uint32_t
+{
+    GLuint buffer;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, sizeof(uint32_t), nullptr, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+    glUseProgram(program);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    uint32_t result{0};
+    glGetNamedBufferSubData(buffer, 0, sizeof(result), &result);
+    glUseProgram(0);
+    glDeleteBuffers(1, &buffer);
+    return result;
+}
+
+auto wait(ShaderLibrary& library, ShaderHandle shader) -> ProgramStatus
+{
+    ProgramStatus status;
+    while ((status = library.poll(shader)) == ProgramStatus::compiling) {
+    }
+    return status;
+}
+} // namespace
+
+TEST(ShaderLibraryPreprocessTest, ResolvesIncludesAndDefines)
+{
+    Logger::set_default(Logger::create_console_logger(Logger::LogLevel::none));
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "not-doom-shader-preprocess-test";
+    std::filesystem::remove_all(directory);
+    write_file(directory / "main.glsl", "#version 450 core\n#include \"a.glsl\"\n  #include \"b/b.glsl\"\nmain\n");
+    write_file(directory / "a.glsl", "a\n#include \"b/b.glsl\"\n");
+    write_file(directory / "b" / "b.glsl", "b\n");
+    write_file(directory / "cycle.glsl", "#include \"cycle.glsl\"\ncycle\n");
+    write_file(directory / "broken.glsl", "#include \"a.glsl\n");
+
+    ProgramCache program_cache;
+    const ShaderLibrary library{program_cache, directory};
+    const std::array defines{ShaderLibrary::Define{.name = "COUNT", .value = "4"}};
+    const auto main = library.preprocess("main.glsl", defines);
+    ASSERT_TRUE(main);
+    // every file once, lines numbered per file by index
+    EXPECT_EQ(main->source, "#version 450 core\n#define COUNT 4\n#line 2 0\n"
+                            "#line 1 1\na\n#line 1 2\nb\n#line 3 1\n#line 3 0\n#line 4 0\nmain\n");
+    ASSERT_EQ(main->files.size(), 3);
+    EXPECT_EQ(main->files[2], directory / "b" / "b.glsl");
+
+    // without #version the defines go first
+    const auto cycle = library.preprocess("cycle.glsl", defines);
+    ASSERT_TRUE(cycle);
+    EXPECT_EQ(cycle->source, "#define COUNT 4\n#line 1 0\n#line 2 0\ncycle\n");
+
+    EXPECT_FALSE(library.preprocess("broken.glsl"));
+    EXPECT_FALSE(library.preprocess("missing.glsl"));
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(ShaderLibraryTest, BuildsPermutationsAndReloads)
+{
+    Logger::set_default(Logger::create_console_logger(Logger::LogLevel::none));
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "not-doom-shader-library-test";
+    std::filesystem::remove_all(directory);
+    write_file(directory / "result.comp", k_compute_shader);
+    write_file(directory / "value.glsl", "#define RESULT (VALUE + 1u)\n");
+
+    ProgramCache program_cache;
+    ShaderLibrary library{program_cache, directory};
+    const std::array stages{ShaderLibrary::Stage{.type = GL_COMPUTE_SHADER, .file_name = "result.comp"}};
+    const std::array one{ShaderLibrary::Define{.name = "VALUE", .value = "1u"}};
+    const std::array two{ShaderLibrary::Define{.name = "VALUE", .value = "2u"}};
+    const auto first = library.load(stages, one);
+    const auto second = library.load(stages, two);
+    ASSERT_TRUE(first && second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(library.load(stages, one), first);
+    EXPECT_FALSE(library.load(std::array{ShaderLibrary::Stage{.type = GL_COMPUTE_SHADER, .file_name = "none"}}));
+
+    ASSERT_EQ(wait(library, *first), ProgramStatus::ready);
+    ASSERT_EQ(wait(library, *second), ProgramStatus::ready);
+    EXPECT_EQ(run(*library.get_program(*first)), 2);
+    EXPECT_EQ(run(*library.get_program(*second)), 3);
+
+    // an edited include rebuilds every permutation using it
+    const auto write_time = std::filesystem::last_write_time(directory / "value.glsl");
+    write_file(directory / "value.glsl", "#define RESULT (VALUE + 10u)\n");
+    std::filesystem::last_write_time(directory / "value.glsl", write_time + std::chrono::seconds{1});
+    library.reload_changed();
+    ASSERT_EQ(wait(library, *first), ProgramStatus::ready);
+    ASSERT_EQ(wait(library, *second), ProgramStatus::ready);
+    EXPECT_EQ(run(*library.get_program(*first)), 11);
+    EXPECT_EQ(run(*library.get_program(*second)), 12);
+
+    // a build that does not compile keeps the previous one
+    write_file(directory / "value.glsl", "#define RESULT nope\n");
+    std::filesystem::last_write_time(directory / "value.glsl", write_time + std::chrono::seconds{2});
+    library.reload_changed();
+    ASSERT_EQ(wait(library, *first), ProgramStatus::ready);
+    EXPECT_EQ(run(*library.get_program(*first)), 11);
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,102 @@
+#include <vector>
+
+#include <gmock/gmock.h> // IWYU pragma: keep
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "Aabb.hpp"
+#include "SpatialHashGrid.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+auto box_at(float x, float y, float z, float half_size = 0.5f) -> Aabb
+{
+    return {{x - half_size, y - half_size, z - half_size}, {x + half_size, y + half_size, z + half_size}};
+}
+} // namespace
+
+TEST(SpatialHashGridTest, FindsOverlappingPair)
+{
+    SpatialHashGrid grid{1.0f};
+    grid.update(0, box_at(0.0f, 0.0f, 0.0f));
+    grid.update(1, box_at(0.5f, 0.0f, 0.0f));
+    grid.update(2, box_at(5.0f, 0.0f, 0.0f));
+
+    std::vector<BroadphasePair> pairs;
+    grid.find_pairs(pairs);
+    EXPECT_THAT(pairs, testing::ElementsAre(BroadphasePair{0, 1}));
+}
+
+TEST(SpatialHashGridTest, ReportsPairSpanningManyCellsOnce)
+{
+    SpatialHashGrid grid{1.0f};
+    grid.update(3, box_at(0.0f, 0.0f, 0.0f, 3.0f));
+    grid.update(1, box_at(0.5f, 0.5f, 0.5f, 2.0f));
+
+    std::vector<BroadphasePair> pairs;
+    grid.find_pairs(pairs);
+    EXPECT_THAT(pairs, testing::ElementsAre(BroadphasePair{1, 3}));
+}
+
+TEST(SpatialHashGridTest, UpdateMovesBetweenCells)
+{
+    SpatialHashGrid grid{1.0f};
+    grid.update(0, box_at(0.0f, 0.0f, 0.0f));
+    grid.update(1, box_at(10.0f, 0.0f, 0.0f));
+
+    std::vector<BroadphasePair> pairs;
+    grid.find_pairs(pairs);
+    EXPECT_TRUE(pairs.empty());
+
+    grid.update(1, box_at(0.25f, 0.0f, 0.0f));
+    grid.find_pairs(pairs);
+    EXPECT_THAT(pairs, testing::ElementsAre(BroadphasePair{0, 1}));
+
+    grid.update(1, box_at(-10.0f, 0.0f, 0.0f));
+    grid.find_pairs(pairs);
+    EXPECT_TRUE(pairs.empty());
+}
+
+TEST(SpatialHashGridTest, Remove)
+{
+    SpatialHashGrid grid{1.0f};
+    grid.update(0, box_at(0.0f, 0.0f, 0.0f));
+    grid.update(1, box_at(0.0f, 0.0f, 0.0f));
+    grid.remove(0);
+
+    EXPECT_FALSE(grid.contains(0));
+    EXPECT_TRUE(grid.contains(1));
+    std::vector<BroadphasePair> pairs;
+    grid.find_pairs(pairs);
+    EXPECT_TRUE(pairs.empty());
+}
+
+TEST(SpatialHashGridTest, Query)
+{
+    SpatialHashGrid grid{1.0f};
+    grid.update(0, box_at(0.0f, 0.0f, 0.0f, 2.0f));
+    grid.update(1, box_at(3.0f, 0.0f, 0.0f));
+    grid.update(2, box_at(-3.0f, 0.0f, 0.0f));
+
+    std::vector<int> result;
+    grid.query(box_at(2.0f, 0.0f, 0.0f), result);
+    EXPECT_THAT(result, testing::ElementsAre(0, 1));
+}
+
+TEST(SpatialHashGridTest, ParallelFindPairsMatchesSerial)
+{
+    SpatialHashGrid grid{1.0f};
+    for (int i = 0; i < 1000; i++) {
+        grid.update(i, box_at(static_cast<float>(i % 10), static_cast<float>(i / 10 % 10), static_cast<float>(i / 100)));
+    }
+
+    std::vector<BroadphasePair> serial_pairs;
+    grid.find_pairs(serial_pairs);
+    ThreadPool thread_pool{3};
+    std::vector<BroadphasePair> parallel_pairs;
+    grid.find_pairs(parallel_pairs, thread_pool);
+    EXPECT_FALSE(serial_pairs.empty());
+    EXPECT_EQ(parallel_pairs, serial_pairs);
+}
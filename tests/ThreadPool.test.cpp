@@ -0,0 +1,39 @@
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <gmock/gmock.h> // IWYU pragma: keep
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "ThreadPool.hpp"
+
+TEST(ThreadPoolTest, VisitsEveryIndexOnce)
+{
+    ThreadPool thread_pool{3};
+    std::vector<std::atomic<int>> visits(1000);
+    for (int repeat = 0; repeat < 10; repeat++) {
+        thread_pool.parallel_for(visits.size(), 7, [&visits](size_t begin, size_t end) {
+            EXPECT_LE(end - begin, 7);
+            for (size_t i = begin; i < end; i++) {
+                visits[i]++;
+            }
+        });
+    }
+    for (const std::atomic<int>& count : visits) {
+        EXPECT_EQ(count.load(), 10);
+    }
+}
+
+TEST(ThreadPoolTest, RunsInlineWithoutWorkers)
+{
+    ThreadPool thread_pool{0};
+    EXPECT_EQ(thread_pool.get_thread_count(), 1);
+    std::vector<size_t> range_begins;
+    thread_pool.parallel_for(25, 10, [&range_begins](size_t begin, size_t end) {
+        EXPECT_EQ(end, begin + 10 < 25 ? begin + 10 : 25);
+        range_begins.push_back(begin);
+    });
+    EXPECT_THAT(range_begins, testing::ElementsAre(0, 10, 20));
+}
@@ -0,0 +1,60 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+// IWYU pragma: no_include <memory> // for allocator
+// IWYU pragma: no_include "gtest/gtest.h" // for DeathTest, Message, TestPartResult
+
+#include "TripleBuffer.hpp"
+
+TEST(TripleBufferTest, ReadsLatestPublished)
+{
+    TripleBuffer<int> triple_buffer;
+    EXPECT_FALSE(triple_buffer.update());
+    EXPECT_EQ(triple_buffer.get_read_buffer(), 0);
+
+    triple_buffer.get_write_buffer() = 1;
+    triple_buffer.publish();
+    triple_buffer.get_write_buffer() = 2;
+    triple_buffer.publish();
+    // unpublished values are not read
+    triple_buffer.get_write_buffer() = 3;
+    EXPECT_TRUE(triple_buffer.update());
+    EXPECT_EQ(triple_buffer.get_read_buffer(), 2);
+    EXPECT_FALSE(triple_buffer.update());
+    EXPECT_EQ(triple_buffer.get_read_buffer(), 2);
+
+    triple_buffer.publish();
+    EXPECT_TRUE(triple_buffer.update());
+    EXPECT_EQ(triple_buffer.get_read_buffer(), 3);
+}
+
+TEST(TripleBufferTest, HandsOverWholeValuesBetweenThreads)
+{
+    constexpr uint32_t publish_count = 20000;
+    TripleBuffer<std::vector<uint32_t>> triple_buffer;
+    std::thread producer{[&triple_buffer] {
+        for (uint32_t i = 1; i <= publish_count; i++) {
+            std::vector<uint32_t>& values = triple_buffer.get_write_buffer();
+            values.assign(16, i);
+            triple_buffer.publish();
+        }
+    }};
+
+    // values only grow and are never torn
+    uint32_t last_value{0};
+    while (last_value < publish_count) {
+        if (!triple_buffer.update()) {
+            continue;
+        }
+        const std::vector<uint32_t>& values = triple_buffer.get_read_buffer();
+        ASSERT_EQ(values.size(), 16);
+        EXPECT_GT(values.front(), last_value);
+        for (const uint32_t value : values) {
+            ASSERT_EQ(value, values.front());
+        }
+        last_value = values.front();
+    }
+    producer.join();
+}